@@ -2,29 +2,114 @@
 #include <vector>
 #include <memory>
 #include "SymbolTable.hpp"
-#include "CodeGenerator.hpp"
+#include "IR.hpp"
 
 using namespace std;
 
+// Symbol, do którego odnosi się węzeł, ustalony przy rozwiązywaniu nazw
+// (po rozmieszczeniu ramek, więc adresy są ostateczne)
+struct SymbolHandle {
+    int64_t memoryPosition = -1;
+    int64_t startIndex = 0;
+    int64_t endIndex = 0;
+    bool isArgument = false;
+
+    SymbolHandle() = default;
+
+    explicit SymbolHandle(const Variable& variable)
+        : memoryPosition(variable.memoryPosition), isArgument(variable.isArgument) {}
+
+    explicit SymbolHandle(const Array& array)
+        : memoryPosition(array.memoryPosition), startIndex(array.startIndex),
+          endIndex(array.endIndex), isArgument(array.isArgument) {}
+
+    IROperand cell() const {
+        return IROperand::cell(memoryPosition);
+    }
+
+    // Adres elementu tablicy o indeksie 0. Parametr tablicowy przechowuje go
+    // w swojej komórce, dla zwykłej tablicy jest stałą.
+    IROperand base() const {
+        if (isArgument) {
+            return IROperand::cell(memoryPosition);
+        }
+        return IROperand::constant(memoryPosition - startIndex);
+    }
+};
+
+// Operatory wyrażeń i warunków
+enum class ArithmeticOperator { PLUS, MINUS, MULTIPLY, DIVIDE, MODULO };
+enum class RelationalOperator { EQUAL, NOTEQUAL, GREATER, LESS, GREATEREQUAL, LESSEQUAL };
+
+inline const char* operatorSymbol(ArithmeticOperator op) {
+    switch (op) {
+    case ArithmeticOperator::PLUS: return "+";
+    case ArithmeticOperator::MINUS: return "-";
+    case ArithmeticOperator::MULTIPLY: return "*";
+    case ArithmeticOperator::DIVIDE: return "/";
+    case ArithmeticOperator::MODULO: return "%";
+    }
+    return "?";
+}
+
+inline const char* operatorSymbol(RelationalOperator op) {
+    switch (op) {
+    case RelationalOperator::EQUAL: return "=";
+    case RelationalOperator::NOTEQUAL: return "!=";
+    case RelationalOperator::GREATER: return ">";
+    case RelationalOperator::LESS: return "<";
+    case RelationalOperator::GREATEREQUAL: return ">=";
+    case RelationalOperator::LESSEQUAL: return "<=";
+    }
+    return "?";
+}
 
 class ASTNode {
 public:
+    // Rodzaj węzła; każda klasa węzła ma własny (KIND), więc rzutowanie
+    // w dół sprawdza tylko znacznik zamiast dynamic_cast
+    enum class Kind {
+        PROC_HEAD, PROGRAM, PROCEDURES, MAIN, PROCEDURE, COMMANDS, IDENTIFIER, VALUE,
+        EXPRESSION, CONDITION, ASSIGNMENT, IF, WHILE, REPEAT, FOR_TO, FOR_DOWN_TO,
+        PROCALL_COMMAND, READ, WRITE, DECLARATIONS, DECLARATION, ARGSDECLS, ARGSDECL,
+        ARG, ARGS, PROC_CALL
+    };
+
+    const Kind kind;
+
+    explicit ASTNode(Kind kind) : kind(kind) {}
     virtual ~ASTNode() = default;
     virtual void print(int indent = 0) const = 0;
     virtual void traverseAndAnalyze(SymbolTable& symbolTable, const std::string& scope) const {};
-    virtual void generateCode(CodeGenerator& codeGenerator, SymbolTable& symbolTable, const std::string& scope) const {};
+    // Rozwiązywanie nazw: węzeł zapamiętuje uchwyty swoich symboli,
+    // generowanie kodu nie zagląda już do tablicy symboli
+    virtual void resolve(SymbolTable& symbolTable, const std::string& scope) {};
+    virtual void generateIR(IRBuilder& builder) const {};
 protected:
     void printIndent(int indent) const {
         for (int i = 0; i < indent; ++i) std::cout << "  ";
     }
 };
 
+// Węzeł jako T albo nullptr, gdy jest innego rodzaju
+template <typename T>
+T* nodeCast(ASTNode* node) {
+    return node && node->kind == T::KIND ? static_cast<T*>(node) : nullptr;
+}
+
+template <typename T>
+const T* nodeCast(const ASTNode* node) {
+    return node && node->kind == T::KIND ? static_cast<const T*>(node) : nullptr;
+}
+
 class ProcHeadNode : public ASTNode {
 public:
-    std::string pidentifier;
+    static constexpr Kind KIND = Kind::PROC_HEAD;
+
+    const std::string& pidentifier;
     
-    ProcHeadNode(std::string pidentifier, std::unique_ptr<ASTNode> args_decl) 
-        : pidentifier(std::move(pidentifier)), args_decl(std::move(args_decl)) {}
+    ProcHeadNode(const std::string& pidentifier, ASTNode* args_decl) 
+        : ASTNode(KIND), pidentifier(pidentifier), args_decl(args_decl) {}
     
     void print(int indent = 0) const override {
         printIndent(indent);
@@ -41,13 +126,15 @@ public:
         if (args_decl) args_decl->traverseAndAnalyze(symbolTable, pidentifier);
     }
 private:
-    std::unique_ptr<ASTNode> args_decl;
+    ASTNode* args_decl;
 };
 
 class ProgramNode : public ASTNode {
 public:
-    ProgramNode(std::unique_ptr<ASTNode> procedures, std::unique_ptr<ASTNode> main)
-        : procedures(std::move(procedures)), main(std::move(main)) {}
+    static constexpr Kind KIND = Kind::PROGRAM;
+
+    ProgramNode(ASTNode* procedures, ASTNode* main)
+        : ASTNode(KIND), procedures(procedures), main(main) {}
 
     void print(int indent = 0) const override {
         std::string indentStr(indent, ' ');
@@ -60,29 +147,34 @@ public:
         if (procedures) procedures->traverseAndAnalyze(symbolTable, "GLOBAL");
         if (main) main->traverseAndAnalyze(symbolTable, "MAIN");
     }
-    
-    void generateCode(CodeGenerator& codeGenerator, SymbolTable& symbolTable, const std::string& scope) const override {
 
-        if (procedures) {
-            codeGenerator.emit("JUMP", 0);
-            procedures->generateCode(codeGenerator, symbolTable, "GLOBAL");
-        }
-        int64_t mainLabel = codeGenerator.getCurrentLine();
-        if (main) main->generateCode(codeGenerator, symbolTable, "MAIN");
-        if (procedures && codeGenerator.getCommand(0).code == "JUMP"){
-            codeGenerator.updateCommand(0, "JUMP", mainLabel);
+    void resolve(SymbolTable& symbolTable, const std::string& scope) override {
+        if (procedures) procedures->resolve(symbolTable, "GLOBAL");
+        if (main) main->resolve(symbolTable, "MAIN");
+    }
+    
+    void generateIR(IRBuilder& builder) const override {
+        if (procedures) procedures->generateIR(builder);
+        if (main) {
+            builder.beginFunction(-1, "MAIN", true, -1);
+            main->generateIR(builder);
+            builder.halt();
+            builder.endFunction();
         }
-        codeGenerator.emit("HALT", 0);
     }
 private:
-    std::unique_ptr<ASTNode> procedures;
-    std::unique_ptr<ASTNode> main;
+    ASTNode* procedures;
+    ASTNode* main;
 };
 
 class ProceduresNode : public ASTNode {
 public:
-    void addProcedure(std::unique_ptr<ASTNode> procedure) {
-        procedures.push_back(std::move(procedure));
+    static constexpr Kind KIND = Kind::PROCEDURES;
+
+    ProceduresNode() : ASTNode(KIND) {}
+
+    void addProcedure(ASTNode* procedure) {
+        procedures.push_back(procedure);
     }
     
     void print(int indent = 0) const override {
@@ -99,19 +191,27 @@ public:
         }
     }
 
-    void generateCode(CodeGenerator& codeGenerator, SymbolTable& symbolTable, const std::string& scope) const override {
+    void resolve(SymbolTable& symbolTable, const std::string& scope) override {
+        for (const auto& procedure : procedures) {
+            procedure->resolve(symbolTable, scope);
+        }
+    }
+
+    void generateIR(IRBuilder& builder) const override {
         for (const auto& procedure : procedures) {
-            procedure->generateCode(codeGenerator, symbolTable, scope);
+            procedure->generateIR(builder);
         }
     }
 private:
-    std::vector<std::unique_ptr<ASTNode>> procedures;
+    std::vector<ASTNode*> procedures;
 };
 
 class MainNode : public ASTNode {
 public:
-    MainNode(std::unique_ptr<ASTNode> declarations, std::unique_ptr<ASTNode> commands)
-        : declarations(std::move(declarations)), commands(std::move(commands)) {}
+    static constexpr Kind KIND = Kind::MAIN;
+
+    MainNode(ASTNode* declarations, ASTNode* commands)
+        : ASTNode(KIND), declarations(declarations), commands(commands) {}
 
     void print(int indent = 0) const override {
         printIndent(indent);
@@ -125,20 +225,28 @@ public:
         if (commands) commands->traverseAndAnalyze(symbolTable, scope);
     }
 
-    void generateCode(CodeGenerator& codeGenerator, SymbolTable& symbolTable, const std::string& scope) const override {
-        if (commands) commands->generateCode(codeGenerator, symbolTable, scope);
+    void resolve(SymbolTable& symbolTable, const std::string& scope) override {
+        if (declarations) declarations->resolve(symbolTable, scope);
+        if (commands) commands->resolve(symbolTable, scope);
+    }
+
+    void generateIR(IRBuilder& builder) const override {
+        if (declarations) declarations->generateIR(builder);
+        if (commands) commands->generateIR(builder);
     }
 private:
-    std::unique_ptr<ASTNode> declarations;
-    std::unique_ptr<ASTNode> commands;
+    ASTNode* declarations;
+    ASTNode* commands;
 };
 
 class ProcedureNode : public ASTNode {
 public:
-    ProcedureNode(std::unique_ptr<ASTNode> procedures, std::unique_ptr<ProcHeadNode> name,
-                  std::unique_ptr<ASTNode> declarations, std::unique_ptr<ASTNode> commands)
-        : procedures(std::move(procedures)), proc_head(std::move(name)),
-          declarations(std::move(declarations)), commands(std::move(commands)) {}
+    static constexpr Kind KIND = Kind::PROCEDURE;
+
+    ProcedureNode(ASTNode* procedures, ProcHeadNode* name,
+                  ASTNode* declarations, ASTNode* commands)
+        : ASTNode(KIND), procedures(procedures), proc_head(name),
+          declarations(declarations), commands(commands) {}
 
     void print(int indent = 0) const override {
         printIndent(indent);
@@ -162,28 +270,56 @@ public:
         if (commands) commands->traverseAndAnalyze(symbolTable, newScope);
     }
 
-    void generateCode(CodeGenerator& codeGenerator, SymbolTable& symbolTable, const std::string& scope) const override {
-        if (procedures) procedures->generateCode(codeGenerator, symbolTable, scope);
+    void resolve(SymbolTable& symbolTable, const std::string& scope) override {
+        if (procedures) procedures->resolve(symbolTable, scope);
         std::string newScope = scope;
         if (proc_head) {
             newScope = proc_head->pidentifier;
         }
-        symbolTable.getProcedure(proc_head->pidentifier, scope)->jumpLabel = codeGenerator.getCurrentLine();
-        if (commands) commands->generateCode(codeGenerator, symbolTable, newScope);
-        codeGenerator.emit("RTRN", symbolTable.getProcedure(proc_head->pidentifier, scope)->returnVariable.memoryPosition);
-    
+        Procedure* procedure = symbolTable.getProcedure(proc_head->pidentifier, scope);
+        functionId = procedure->id;
+        returnCell = procedure->returnVariable.memoryPosition;
+        parameters.clear();
+        for (const auto& param : procedure->params) {
+            if (param->kind == Param::Kind::VARIABLE) {
+                parameters.push_back({symbolTable.getVariable(param->name(), newScope)->memoryPosition, false});
+            } else {
+                parameters.push_back({symbolTable.getArray(param->name(), newScope)->memoryPosition, true});
+            }
+        }
+        if (declarations) declarations->resolve(symbolTable, newScope);
+        if (commands) commands->resolve(symbolTable, newScope);
+    }
+
+    void generateIR(IRBuilder& builder) const override {
+        if (procedures) procedures->generateIR(builder);
+        builder.beginFunction(functionId, proc_head->pidentifier, false, returnCell);
+        for (const auto& [cell, isArray] : parameters) {
+            builder.addParameter(cell, isArray);
+        }
+        if (declarations) declarations->generateIR(builder);
+        if (commands) commands->generateIR(builder);
+        builder.ret();
+        builder.endFunction();
     }
 private:
-    std::unique_ptr<ASTNode> procedures;
-    std::unique_ptr<ProcHeadNode> proc_head;
-    std::unique_ptr<ASTNode> declarations;
-    std::unique_ptr<ASTNode> commands;
+    ASTNode* procedures;
+    ProcHeadNode* proc_head;
+    ASTNode* declarations;
+    ASTNode* commands;
+    int64_t functionId = -1;
+    int64_t returnCell = -1;
+    std::vector<std::pair<int64_t, bool>> parameters;   // komórka parametru, czy jest tablicą
 };
 
 class CommandsNode : public ASTNode {
 public:
-    void addCommand(std::unique_ptr<ASTNode> command) {
-        commands.push_back(std::move(command));
+    static constexpr Kind KIND = Kind::COMMANDS;
+
+    CommandsNode() : ASTNode(KIND) {}
+
+    void addCommand(ASTNode* command) {
+        commands.push_back(command);
     }
 
     void print(int indent = 0) const override {
@@ -200,35 +336,43 @@ public:
         }
     }
 
-    void generateCode(CodeGenerator& codeGenerator, SymbolTable& symbolTable, const std::string& scope) const override {
+    void resolve(SymbolTable& symbolTable, const std::string& scope) override {
+        for (const auto& command : commands) {
+            command->resolve(symbolTable, scope);
+        }
+    }
+
+    void generateIR(IRBuilder& builder) const override {
         for (const auto& command : commands) {
-            command->generateCode(codeGenerator, symbolTable, scope);
+            command->generateIR(builder);
         }
     }
 private:
-    std::vector<std::unique_ptr<ASTNode>> commands;
+    std::vector<ASTNode*> commands;
 };
 
 class IdentifierNode : public ASTNode {
 public:
+    static constexpr Kind KIND = Kind::IDENTIFIER;
+
     enum IdentifierType {
         SIMPLE,
         INDEXED_ID,
         INDEXED_NUM
     };
 
-    std::string getPidentifier() const {
+    const std::string& getPidentifier() const {
         return pidentifier;
     }
 
-    IdentifierNode(std::string identifier)
-        : identifierType(SIMPLE), pidentifier(std::move(identifier)) {}
+    IdentifierNode(const std::string& identifier)
+        : ASTNode(KIND), identifierType(SIMPLE), pidentifier(identifier), indexIdentifier(noIndex) {}
 
-    IdentifierNode(std::string identifier, int64_t index)
-        : identifierType(INDEXED_NUM), pidentifier(std::move(identifier)), index(index) {}
+    IdentifierNode(const std::string& identifier, int64_t index)
+        : ASTNode(KIND), identifierType(INDEXED_NUM), pidentifier(identifier), index(index), indexIdentifier(noIndex) {}
 
-    IdentifierNode(std::string identifier, std::string index)
-        : identifierType(INDEXED_ID), pidentifier(std::move(identifier)), indexIdentifier(index) {}
+    IdentifierNode(const std::string& identifier, const std::string& index)
+        : ASTNode(KIND), identifierType(INDEXED_ID), pidentifier(identifier), indexIdentifier(index) {}
 
 
     void print(int indent = 0) const override {
@@ -260,10 +404,10 @@ public:
                     return true;
                 }
                 if (index < symbolTable.getArray(pidentifier, scope)->startIndex || index > symbolTable.getArray(pidentifier, scope)->endIndex) {
-                    std::cerr << "Error: Index out of bounds for array " << pidentifier << " in scope " << scope << "\n";
+                    symbolTable.diagnostics->report("Error: Index out of bounds for array " + pidentifier + " in scope " + scope);
                     return false;
                 }
-                return symbolTable.getArray(pidentifier, scope)->isInitialized[index];
+                return symbolTable.getArray(pidentifier, scope)->isInitialized(index);
             }
         default:
             return false;
@@ -278,13 +422,13 @@ public:
             break;
         case INDEXED_ID:
             if(!symbolTable.arrayExists(pidentifier, scope)){
-                std::cerr << "Error: Array " << pidentifier << " not declared in scope " << scope << "\n";
+                symbolTable.diagnostics->report("Error: Array " + pidentifier + " not declared in scope " + scope);
             }
             if(!symbolTable.variableExists(indexIdentifier, scope)){
-                std::cerr << "Error: Variable " << indexIdentifier << " not declared in scope " << scope << "\n";
+                symbolTable.diagnostics->report("Error: Variable " + indexIdentifier + " not declared in scope " + scope);
             }
             if(!symbolTable.getVariable(indexIdentifier, scope)->isInitialized){
-                std::cerr << "Error: Variable " << indexIdentifier << " not initialized in scope " << scope << "\n";
+                symbolTable.diagnostics->report("Error: Variable " + indexIdentifier + " not initialized in scope " + scope);
             }
             break;
         case INDEXED_NUM:
@@ -293,9 +437,9 @@ public:
                     return;
                 }
                 if (index < symbolTable.getArray(pidentifier, scope)->startIndex || index > symbolTable.getArray(pidentifier, scope)->endIndex) {
-                    std::cerr << "Error: Index out of bounds for array " << pidentifier << " in scope " << scope << "\n";
+                    symbolTable.diagnostics->report("Error: Index out of bounds for array " + pidentifier + " in scope " + scope);
                 }
-                symbolTable.getArray(pidentifier, scope)->isInitialized[index] = true;
+                symbolTable.getArray(pidentifier, scope)->setInitialized(index);
             }
             break;
         default:
@@ -335,32 +479,26 @@ public:
         }
     }
 
-    std::int64_t getMemoryPosition(SymbolTable& symbolTable, const std::string& scope) const {
-        int64_t memoryPosition;
-        switch (identifierType)
-        {
-        case SIMPLE:
-            return symbolTable.getVariable(pidentifier, scope)->memoryPosition;
-        case INDEXED_ID:
-            return -1;
-        case INDEXED_NUM:
-            memoryPosition = symbolTable.getArray(pidentifier, scope)->memoryPosition;
-            return memoryPosition + (index-symbolTable.getArray(pidentifier, scope)->startIndex);
-        default:
-            return -1;
+    void resolve(SymbolTable& symbolTable, const std::string& scope) override {
+        if (identifierType == SIMPLE) {
+            symbol = SymbolHandle(*symbolTable.getVariable(pidentifier, scope));
+            return;
+        }
+        symbol = SymbolHandle(*symbolTable.getArray(pidentifier, scope));
+        if (identifierType == INDEXED_ID) {
+            indexSymbol = SymbolHandle(*symbolTable.getVariable(indexIdentifier, scope));
         }
-        return -1;
     }
 
-    std::int64_t getStartMemoryPosition(SymbolTable& symbolTable, const std::string& scope) const {
+    std::int64_t getMemoryPosition() const {
         switch (identifierType)
         {
         case SIMPLE:
-            return symbolTable.getVariable(pidentifier, scope)->memoryPosition;
+            return symbol.memoryPosition;
         case INDEXED_ID:
-            return symbolTable.getArray(pidentifier, scope)->memoryPosition;
+            return -1;
         case INDEXED_NUM:
-            return symbolTable.getArray(pidentifier, scope)->memoryPosition;
+            return symbol.memoryPosition + index - symbol.startIndex;
         default:
             return -1;
         }
@@ -371,70 +509,70 @@ public:
         return identifierType;
     }
     
-    void generateCode(CodeGenerator& codeGenerator, SymbolTable& symbolTable, const std::string& scope) const override {  
-        int64_t memoryPosition;
-        int64_t indexMemoryPosition;
-        bool isArgument;
+    // Czy adres jest znany w czasie kompilacji (zmienna albo element zwykłej tablicy o stałym indeksie)
+    bool hasDirectCell() const {
         switch (identifierType)
         {
         case SIMPLE:
-            codeGenerator.emit("LOAD", symbolTable.getVariable(pidentifier, scope)->memoryPosition);     
-            break;
-        case INDEXED_ID:
-            memoryPosition = symbolTable.getArray(pidentifier, scope)->memoryPosition;
-            indexMemoryPosition = symbolTable.getVariable(indexIdentifier, scope)->memoryPosition;
-            isArgument = symbolTable.getArray(pidentifier, scope)->isArgument;
-            if (!isArgument){
-                codeGenerator.emit("SET", memoryPosition - symbolTable.getArray(pidentifier, scope)->startIndex);
-                codeGenerator.emit("ADD", indexMemoryPosition);
-                codeGenerator.emit("LOADI", 0);
-            } else {
-                codeGenerator.emit("LOAD", indexMemoryPosition);
-                codeGenerator.emit("ADD", memoryPosition);
-                codeGenerator.emit("LOADI", 0);
-            }
-            break;
+            return true;
         case INDEXED_NUM:
-            memoryPosition = symbolTable.getArray(pidentifier, scope)->memoryPosition;
-            isArgument = symbolTable.getArray(pidentifier, scope)->isArgument;
-            if (!isArgument){
-                codeGenerator.emit("LOAD", memoryPosition + (index-symbolTable.getArray(pidentifier, scope)->startIndex));
-            } else {
-                codeGenerator.emit("SET", index);
-                codeGenerator.emit("ADD", memoryPosition);
-                codeGenerator.emit("LOADI", 0);
-            }
-             break;
+            return !symbol.isArgument;
         default:
-            break;
+            return false;
         }
     }
 
+    // Adres elementu tablicy wyliczany w czasie działania programu
+    IROperand generateAddress(IRBuilder& builder) const {
+        IROperand offset = IROperand::constant(index);
+        if (identifierType == INDEXED_ID) {
+            offset = indexSymbol.cell();
+        }
+        IROperand address = builder.newTemp();
+        builder.binary(IROpcode::ADD, address, symbol.base(), offset);
+        return address;
+    }
+
+    IROperand generateValue(IRBuilder& builder) const {
+        if (hasDirectCell()) {
+            return IROperand::cell(getMemoryPosition());
+        }
+        IROperand address = generateAddress(builder);
+        IROperand value = builder.newTemp();
+        builder.load(value, address);
+        return value;
+    }
+
     
     int64_t getIndex() const {
         return index;
     }
     
-    std::string getIndexIdentifier() const {
+    const std::string& getIndexIdentifier() const {
         return indexIdentifier;
     }
 
     IdentifierType identifierType;
 private:
-    std::string pidentifier;
+    const std::string& pidentifier;
     int64_t index;
-    std::string indexIdentifier;
+    const std::string& indexIdentifier;
+    static inline const std::string noIndex;
+    SymbolHandle symbol;
+    SymbolHandle indexSymbol;
 };
 
 class ValueNode : public ASTNode {
 public:
+    static constexpr Kind KIND = Kind::VALUE;
+
     bool isIdentifier;
 
     ValueNode(int64_t value) 
-        : isIdentifier(false),value(value) {}
+        : ASTNode(KIND), isIdentifier(false),value(value) {}
 
-    ValueNode(std::unique_ptr<ASTNode> identifierNode) 
-        : isIdentifier(true), identifierNode(std::move(identifierNode)) {}
+    ValueNode(ASTNode* identifierNode) 
+        : ASTNode(KIND), isIdentifier(true), identifierNode(identifierNode) {}
 
     void print(int indent = 0) const override {
         printIndent(indent);
@@ -448,10 +586,16 @@ public:
         }
     }
 
+    void resolve(SymbolTable& symbolTable, const std::string& scope) override {
+        if (isIdentifier && identifierNode) {
+            identifierNode->resolve(symbolTable, scope);
+        }
+    }
+
     bool isVariableInitialized(SymbolTable& symbolTable, const std::string& scope) const {
         if (isIdentifier) {
             if (identifierNode) {
-                auto idNode = dynamic_cast<IdentifierNode*>(identifierNode.get());
+                auto idNode = nodeCast<IdentifierNode>(identifierNode);
                 if(idNode){
                     if (idNode->isInitialized(symbolTable, scope)) {
                         return true;
@@ -465,7 +609,7 @@ public:
 
     std::string getPidentifier() const {
         if (isIdentifier) {
-            auto idNode = dynamic_cast<IdentifierNode*>(identifierNode.get());
+            auto idNode = nodeCast<IdentifierNode>(identifierNode);
             if (idNode) {
                 return idNode->getPidentifier();
             }
@@ -480,12 +624,12 @@ public:
         return value;
     }
 
-    int64_t getMemoryPosition(SymbolTable& symbolTable, const std::string& scope) const {
+    int64_t getMemoryPosition() const {
         if (isIdentifier) {
             if (identifierNode) {
-                auto idNode = dynamic_cast<IdentifierNode*>(identifierNode.get());
+                auto idNode = nodeCast<IdentifierNode>(identifierNode);
                 if (idNode) {
-                    return idNode->getMemoryPosition(symbolTable, scope);
+                    return idNode->getMemoryPosition();
                 }
             }
         }
@@ -493,30 +637,26 @@ public:
     }
     
     IdentifierNode* getIdentifierNode() const {
-        return dynamic_cast<IdentifierNode*>(identifierNode.get());
+        return nodeCast<IdentifierNode>(identifierNode);
     }
    
-    void generateCode(CodeGenerator& codeGenerator, SymbolTable& symbolTable, const std::string& scope) const override {
+    IROperand generateValue(IRBuilder& builder) const {
         if (isIdentifier) {
-            if (identifierNode) {
-                auto idNode = dynamic_cast<IdentifierNode*>(identifierNode.get());
-                if (idNode ) {
-                    idNode->generateCode(codeGenerator, symbolTable, scope);
-                }
-            }
-        } else {
-            codeGenerator.emit("SET", value);
+            return getIdentifierNode()->generateValue(builder);
         }
+        return IROperand::constant(value);
     }
 private:
     int64_t value;
-    mutable std::unique_ptr<ASTNode>  identifierNode;
+    ASTNode* identifierNode;
 };
 
 class ExpressionNode : public ASTNode {
 public:
-    ExpressionNode(std::unique_ptr<ASTNode> leftValue, std::string op, std::unique_ptr<ASTNode> rightValue)
-        : leftValue(std::move(leftValue)), op(std::move(op)), rightValue(std::move(rightValue)) {
+    static constexpr Kind KIND = Kind::EXPRESSION;
+
+    ExpressionNode(ASTNode* leftValue, ArithmeticOperator op, ASTNode* rightValue)
+        : ASTNode(KIND), leftValue(leftValue), op(op), rightValue(rightValue) {
 
         }
     
@@ -529,7 +669,7 @@ public:
             leftValue->print(indent + 2);  
         }
         printIndent(indent + 1);
-        std::cout << "Operator: " << op << "\n";
+        std::cout << "Operator: " << operatorSymbol(op) << "\n";
         printIndent(indent + 1);
         std::cout << "RightValue:\n";
         if (rightValue) {
@@ -539,7 +679,7 @@ public:
 
     bool isVariablesInitialized(SymbolTable& symbolTable, const std::string& scope) const {
         if (leftValue) {
-            auto leftIdNode = dynamic_cast<ValueNode*>(leftValue.get());
+            auto leftIdNode = nodeCast<ValueNode>(leftValue);
             if (leftIdNode) {
                 if (!leftIdNode->isVariableInitialized(symbolTable, scope)) {
                     throw std::runtime_error("Error: Variable is not initialized in scope " + scope);
@@ -548,7 +688,7 @@ public:
             }
         }
         if (rightValue) {
-            auto rightIdNode = dynamic_cast<ValueNode*>(rightValue.get());
+            auto rightIdNode = nodeCast<ValueNode>(rightValue);
             if (rightIdNode) {
                 if (!rightIdNode->isVariableInitialized(symbolTable, scope)) {
                     throw std::runtime_error("Error: Variable is not initialized in scope " + scope);
@@ -564,827 +704,100 @@ public:
         if (rightValue) rightValue->traverseAndAnalyze(symbolTable, scope);
     }
 
-    void generateCode(CodeGenerator& codeGenerator, SymbolTable& symbolTable, const std::string& scope) const override {
-        auto leftIdNode = dynamic_cast<ValueNode*>(leftValue.get());
-        auto rightIdNode = dynamic_cast<ValueNode*>(rightValue.get());
-        if (leftIdNode->isIdentifier && rightIdNode->isIdentifier) {
-            int64_t leftMemoryPosition = leftIdNode->getMemoryPosition(symbolTable, scope);
-            int64_t rightMemoryPosition = rightIdNode->getMemoryPosition(symbolTable, scope);
-            auto leftId = leftIdNode->getIdentifierNode();
-            auto rightId = rightIdNode->getIdentifierNode();
-            if (!leftId->identifierType == IdentifierNode::IdentifierType::SIMPLE ){
-                leftIdNode->generateCode(codeGenerator, symbolTable, scope);
-                codeGenerator.emit("STORE", 6);
-                leftMemoryPosition = 6;
-            }
-            if(!rightId->identifierType == IdentifierNode::IdentifierType::SIMPLE){
-                rightIdNode->generateCode(codeGenerator, symbolTable, scope);
-                codeGenerator.emit("STORE", 7);
-                rightMemoryPosition = 7;
-            }
-            
-            if(op == "+"){
-                codeGenerator.emit("LOAD", leftMemoryPosition);
-                codeGenerator.emit("ADD", rightMemoryPosition);
-            }
-            if (op == "-"){
-                codeGenerator.emit("LOAD", leftMemoryPosition);
-                codeGenerator.emit("SUB", rightMemoryPosition);
-            }
-            if (op == "*"){
-                int64_t one;
-                if(symbolTable.one){
-                    one = 0;
-                }else {
-                    one = 1;
-                }
-                codeGenerator.emit("LOAD", leftMemoryPosition);
-                codeGenerator.emit("JZERO", 46 + one);
-                codeGenerator.emit("JPOS", 3);
-                codeGenerator.emit("SUB", leftMemoryPosition);
-                codeGenerator.emit("SUB", leftMemoryPosition);
-                codeGenerator.emit("STORE", 1);   
-                codeGenerator.emit("LOAD", rightMemoryPosition);
-                codeGenerator.emit("JZERO", 40 + one);
-                codeGenerator.emit("JPOS", 3);
-                codeGenerator.emit("SUB", rightMemoryPosition);
-                codeGenerator.emit("SUB", rightMemoryPosition);
-                codeGenerator.emit("STORE", 2);
-                codeGenerator.emit("SUB", 0);
-                codeGenerator.emit("STORE", 3);             
-                codeGenerator.emit("LOAD", 2);
-                codeGenerator.emit("JPOS", 2);
-                if (one == 1){
-                    codeGenerator.emit("JUMP", 20);
-                } else {
-                    codeGenerator.emit("JUMP", 19);
-                }
-                codeGenerator.emit("HALF", 0);
-                codeGenerator.emit("ADD", 0);
-                codeGenerator.emit("SUB", 2);
-                codeGenerator.emit("STORE", 5);
-                if (symbolTable.one){
-                    codeGenerator.emit("LOAD", 10);
-                } else {
-                    codeGenerator.emit("SET", 1);
-                    codeGenerator.emit("STORE", 10);
-                    symbolTable.one = true;
-                }
-                codeGenerator.emit("ADD", 5);
-                codeGenerator.emit("JZERO", 2);
-                codeGenerator.emit("JUMP", 4);
-                codeGenerator.emit("LOAD", 3);
-                codeGenerator.emit("ADD", 1);
-                codeGenerator.emit("STORE", 3);
-                codeGenerator.emit("LOAD", 1);
-                codeGenerator.emit("ADD", 1);
-                codeGenerator.emit("STORE", 1);
-                codeGenerator.emit("LOAD", 2);
-                codeGenerator.emit("HALF", 0);
-                codeGenerator.emit("STORE", 2);
-                if(one == 1){
-                    codeGenerator.emit("JUMP", -21);
-                } else {
-                    codeGenerator.emit("JUMP", -20);
-                }
-                codeGenerator.emit("LOAD", leftMemoryPosition);
-                codeGenerator.emit("JPOS", 4);
-                codeGenerator.emit("LOAD", rightMemoryPosition);
-                codeGenerator.emit("JNEG", 8);
-                codeGenerator.emit("JUMP",3);
-                codeGenerator.emit("LOAD", rightMemoryPosition);
-                codeGenerator.emit("JPOS", 5);
-                codeGenerator.emit("LOAD", 3);
-                codeGenerator.emit("SUB", 3);
-                codeGenerator.emit("SUB", 3);
-                codeGenerator.emit("JUMP", 2);
-                codeGenerator.emit("LOAD", 3);
-            }
-            if (op == "/"){
-                int64_t one;
-                if(symbolTable.one){
-                    one = 0;
-                }else {
-                    one = 1;
-                }
-
-                codeGenerator.emit("LOAD", rightMemoryPosition);
-                codeGenerator.emit("JZERO", 51+one);
-                codeGenerator.emit("JPOS", 3);
-                codeGenerator.emit("SUB", rightMemoryPosition);
-                codeGenerator.emit("SUB", rightMemoryPosition);
-                codeGenerator.emit("STORE",5);
-                codeGenerator.emit("STORE",1);
-
-                codeGenerator.emit("LOAD",leftMemoryPosition);
-                codeGenerator.emit("JZERO", 45+one);
-                codeGenerator.emit("JPOS", 3);
-                codeGenerator.emit("SUB", leftMemoryPosition);
-                codeGenerator.emit("SUB", leftMemoryPosition);
-                codeGenerator.emit("STORE",4 );
-
-                if (!symbolTable.one){
-                    codeGenerator.emit("SET", 1);
-                    codeGenerator.emit("STORE", 10);
-                    symbolTable.one = true;
-                } else {
-                    codeGenerator.emit("LOAD", 10);
-                }
-                codeGenerator.emit("STORE",2);
-
-                codeGenerator.emit("SUB", 0);
-                codeGenerator.emit("STORE",3);
-
-                codeGenerator.emit("LOAD", 4);
-                codeGenerator.emit("SUB", 1);
-                codeGenerator.emit("JNEG", 8);
-                codeGenerator.emit("LOAD", 1);
-                codeGenerator.emit("ADD", 0);
-                codeGenerator.emit("STORE", 1);
-                codeGenerator.emit("LOAD", 2);
-                codeGenerator.emit("ADD", 0);
-                codeGenerator.emit("STORE", 2);
-                codeGenerator.emit("JUMP", -9);
-                codeGenerator.emit("LOAD", 2);
-                codeGenerator.emit("HALF", 0);
-                codeGenerator.emit("STORE", 2);
-                codeGenerator.emit("LOAD", 1);
-                codeGenerator.emit("HALF", 0);
-                codeGenerator.emit("STORE", 1);              
-                codeGenerator.emit("LOAD", 4);
-                codeGenerator.emit("SUB", 5);
-                codeGenerator.emit("JNEG", 17);
-                codeGenerator.emit("LOAD", 4);
-                codeGenerator.emit("SUB", 1);
-                codeGenerator.emit("JNEG", 7);
-                codeGenerator.emit("LOAD", 4);
-                codeGenerator.emit("SUB", 1);
-                codeGenerator.emit("STORE", 4);
-                codeGenerator.emit("LOAD", 3);
-                codeGenerator.emit("ADD", 2);
-                codeGenerator.emit("STORE", 3);
-                codeGenerator.emit("LOAD", 2);
-                codeGenerator.emit("HALF", 0);
-                codeGenerator.emit("STORE", 2);
-                codeGenerator.emit("LOAD", 1);
-                codeGenerator.emit("HALF", 0);
-                codeGenerator.emit("STORE", 1);
-                codeGenerator.emit("JUMP", -18);
-
-                codeGenerator.emit("LOAD", leftMemoryPosition);
-                codeGenerator.emit("JPOS", 4);
-                codeGenerator.emit("LOAD", rightMemoryPosition);
-                codeGenerator.emit("JPOS", 4);
-                codeGenerator.emit("JUMP", 7);
-                codeGenerator.emit("LOAD", rightMemoryPosition);
-                codeGenerator.emit("JPOS", 5);
-                codeGenerator.emit("LOAD", 3);
-                codeGenerator.emit("SUB", 3);
-                codeGenerator.emit("SUB", 3);
-                codeGenerator.emit("JUMP", 2);
-                codeGenerator.emit("LOAD", 3);
-            }
-            if (op == "%"){
-                codeGenerator.emit("LOAD", rightMemoryPosition);
-                codeGenerator.emit("JZERO", 43);
-                codeGenerator.emit("JPOS", 3);
-                codeGenerator.emit("SUB", rightMemoryPosition);
-                codeGenerator.emit("SUB", rightMemoryPosition);
-                codeGenerator.emit("STORE",3);
-                codeGenerator.emit("STORE",1);
-
-                codeGenerator.emit("LOAD",leftMemoryPosition);
-                codeGenerator.emit("JZERO", 30);
-                codeGenerator.emit("JPOS", 3);
-                codeGenerator.emit("SUB", leftMemoryPosition);
-                codeGenerator.emit("SUB", leftMemoryPosition);
-                codeGenerator.emit("STORE",2 );
-
-                codeGenerator.emit("LOAD", 2);
-                codeGenerator.emit("SUB", 1);
-                codeGenerator.emit("JNEG", 5);
-                codeGenerator.emit("LOAD", 1);
-                codeGenerator.emit("ADD", 0);
-                codeGenerator.emit("STORE", 1);
-                codeGenerator.emit("JUMP", -6);
-
-                codeGenerator.emit("LOAD", 1);
-                codeGenerator.emit("HALF", 0);
-                codeGenerator.emit("STORE", 1);          
-
-                codeGenerator.emit("LOAD", 2);
-                codeGenerator.emit("SUB", 3);
-                codeGenerator.emit("JNEG", 11);
-                codeGenerator.emit("LOAD", 2);
-                codeGenerator.emit("SUB", 1);
-                codeGenerator.emit("JNEG", 4);
-                codeGenerator.emit("LOAD", 2);
-                codeGenerator.emit("SUB", 1);
-                codeGenerator.emit("STORE", 2);
-                codeGenerator.emit("LOAD", 1);
-                codeGenerator.emit("HALF", 0);
-                codeGenerator.emit("STORE", 1);
-                codeGenerator.emit("JUMP", -12);
-
-                codeGenerator.emit("LOAD", rightMemoryPosition);
-                codeGenerator.emit("JPOS", 5);
-                codeGenerator.emit("LOAD", 2);
-                codeGenerator.emit("SUB", 2);
-                codeGenerator.emit("SUB", 2);
-                codeGenerator.emit("JUMP", 2);
-                codeGenerator.emit("LOAD", 2);
-            }
-        } else if (leftIdNode->isIdentifier && !rightIdNode->isIdentifier) {
-            int64_t leftMemoryPosition = leftIdNode->getMemoryPosition(symbolTable, scope);
-            int64_t rightValue = rightIdNode->getValue();
-            auto leftId = leftIdNode->getIdentifierNode();
-            if (!leftId->identifierType == IdentifierNode::IdentifierType::SIMPLE ){
-                leftIdNode->generateCode(codeGenerator, symbolTable, scope);
-                codeGenerator.emit("STORE", 6);
-                leftMemoryPosition = 6;
-            }
-
-            if(op == "+"){
-                codeGenerator.emit("SET", rightValue);
-                codeGenerator.emit("ADD", leftMemoryPosition);
-            }
-            if (op == "-"){
-                codeGenerator.emit("SET", rightValue);
-                codeGenerator.emit("STORE", 1);
-                codeGenerator.emit("LOAD", leftMemoryPosition);
-                codeGenerator.emit("SUB", 1);
-            }
-            if (op == "*"){
-                if (rightValue==0) {
-                    codeGenerator.emit("SUB", 0);
-                } else if (rightValue%2==0){
-                    codeGenerator.emit("LOAD", leftMemoryPosition);
-                    while(rightValue!=-1 && rightValue!=1){
-                        codeGenerator.emit("ADD", 0);
-                        rightValue = rightValue/2;
-                    }
-                } else {
-                    int64_t one;
-                    if(symbolTable.one){
-                        one = 0;
-                    }else {
-                        one = 1;
-                    }
-                    codeGenerator.emit("LOAD", leftMemoryPosition);
-                    codeGenerator.emit("JZERO", 37 + one);
-                    codeGenerator.emit("JPOS", 3);
-                    codeGenerator.emit("SUB", leftMemoryPosition);
-                    codeGenerator.emit("SUB", leftMemoryPosition);
-                    codeGenerator.emit("STORE", 1);   
-                    if(rightValue<0){
-                        codeGenerator.emit("SET", -rightValue);
-                        codeGenerator.emit("STORE", 2);
-                    } else {
-                        codeGenerator.emit("SET", rightValue);
-                        codeGenerator.emit("STORE",2);
-                    }
-                    codeGenerator.emit("SUB", 0);
-                    codeGenerator.emit("STORE", 3);             
-                    codeGenerator.emit("LOAD", 2);
-                    codeGenerator.emit("JPOS", 2);
-                    if (one == 1){
-                        codeGenerator.emit("JUMP", 20);
-                    } else {
-                        codeGenerator.emit("JUMP", 19);
-                    }
-                    codeGenerator.emit("HALF", 0);
-                    codeGenerator.emit("ADD", 0);
-                    codeGenerator.emit("SUB", 2);
-                    codeGenerator.emit("STORE", 5);
-                    if (symbolTable.one){
-                        codeGenerator.emit("LOAD", 10);
-                    } else {
-                        codeGenerator.emit("SET", 1);
-                        codeGenerator.emit("STORE", 10);
-                        symbolTable.one = true;
-                    }
-                    codeGenerator.emit("ADD", 5);
-                    codeGenerator.emit("JZERO", 2);
-                    codeGenerator.emit("JUMP", 4);
-                    codeGenerator.emit("LOAD", 3);
-                    codeGenerator.emit("ADD", 1);
-                    codeGenerator.emit("STORE", 3);
-                    codeGenerator.emit("LOAD", 1);
-                    codeGenerator.emit("ADD", 1);
-                    codeGenerator.emit("STORE", 1);
-                    codeGenerator.emit("LOAD", 2);
-                    codeGenerator.emit("HALF", 0);
-                    codeGenerator.emit("STORE", 2);
-                    if(one == 1){
-                        codeGenerator.emit("JUMP", -21);
-                    } else {
-                        codeGenerator.emit("JUMP", -20);
-                    }
-                    if(rightValue>0){
-                        codeGenerator.emit("LOAD", leftMemoryPosition);
-                        codeGenerator.emit("JPOS", 5);
-                        codeGenerator.emit("LOAD", 3);
-                        codeGenerator.emit("SUB", 3);
-                        codeGenerator.emit("SUB", 3);
-                        codeGenerator.emit("JUMP", 2);
-                        codeGenerator.emit("LOAD", 3);
-                    } else {
-                        codeGenerator.emit("LOAD", leftMemoryPosition);
-                        codeGenerator.emit("JPOS", 3);
-                        codeGenerator.emit("LOAD", 3);
-                        codeGenerator.emit("JUMP", 2);
-                        codeGenerator.emit("LOAD", 3);
-                        codeGenerator.emit("SUB", 3);
-                        codeGenerator.emit("SUB", 3);
-                    }
-                }
-            }
-            if (op == "/"){
-                int64_t one;
-                if(symbolTable.one){
-                    one = 0;
-                }else {
-                    one = 1;
-                }
-                if (rightValue == 0){
-                    codeGenerator.emit("SUB", 0);
-                } else if (rightValue == 1) {
-                    codeGenerator.emit("LOAD", leftMemoryPosition);
-                } else if (rightValue == -1) {
-                    codeGenerator.emit("LOAD", leftMemoryPosition);
-                    codeGenerator.emit("SUB", 0);
-                    codeGenerator.emit("SUB", leftMemoryPosition);
-                }else if (rightValue == 2) {
-                    codeGenerator.emit("LOAD", leftMemoryPosition);
-                    codeGenerator.emit("HALF", 0);
-                } else if (rightValue == -2) {
-                    codeGenerator.emit("LOAD", leftMemoryPosition);
-                    codeGenerator.emit("SUB", 0);
-                    codeGenerator.emit("SUB", leftMemoryPosition);
-                    codeGenerator.emit("HALF", 0);
-                } else {
-                    if (rightValue<0){
-                        codeGenerator.emit("SET", -rightValue);
-                        codeGenerator.emit("STORE", 1);
-                        codeGenerator.emit("STORE", 5);
-                    } else {
-                        codeGenerator.emit("SET", rightValue);
-                        codeGenerator.emit("STORE",1);
-                        codeGenerator.emit("STORE",5);
-                    }
-                    codeGenerator.emit("LOAD",leftMemoryPosition);
-                    codeGenerator.emit("JZERO", 41+one);
-                    codeGenerator.emit("JPOS", 3);
-                    codeGenerator.emit("SUB", leftMemoryPosition);
-                    codeGenerator.emit("SUB", leftMemoryPosition);
-                    codeGenerator.emit("STORE",4 );
-                    if (!symbolTable.one){
-                        codeGenerator.emit("SET", 1);
-                        codeGenerator.emit("STORE", 10);
-                        symbolTable.one = true;
-                    } else {
-                        codeGenerator.emit("LOAD", 10);
-                    }
-                    codeGenerator.emit("STORE",2);
-                    codeGenerator.emit("SUB", 0);
-                    codeGenerator.emit("STORE",3);
-
-                    codeGenerator.emit("LOAD", 4);
-                    codeGenerator.emit("SUB", 1);
-                    codeGenerator.emit("JNEG", 8);
-                    codeGenerator.emit("LOAD", 1);
-                    codeGenerator.emit("ADD", 0);
-                    codeGenerator.emit("STORE", 1);
-                    codeGenerator.emit("LOAD", 2);
-                    codeGenerator.emit("ADD", 0);
-                    codeGenerator.emit("STORE", 2);
-                    codeGenerator.emit("JUMP", -9);
-
-                    codeGenerator.emit("LOAD", 2);
-                    codeGenerator.emit("HALF", 0);
-                    codeGenerator.emit("STORE", 2);
-
-                    codeGenerator.emit("LOAD", 1);
-                    codeGenerator.emit("HALF", 0);
-                    codeGenerator.emit("STORE", 1);
-                    
-                    codeGenerator.emit("LOAD", 4);
-                    codeGenerator.emit("SUB", 5);
-                    codeGenerator.emit("JNEG", 17);
-                    codeGenerator.emit("LOAD", 4);
-                    codeGenerator.emit("SUB", 1);
-                    codeGenerator.emit("JNEG", 7);
-                    codeGenerator.emit("LOAD", 4);
-                    codeGenerator.emit("SUB", 1);
-                    codeGenerator.emit("STORE", 4);
-                    codeGenerator.emit("LOAD", 3);
-                    codeGenerator.emit("ADD", 2);
-                    codeGenerator.emit("STORE", 3);
-
-                    codeGenerator.emit("LOAD", 2);
-                    codeGenerator.emit("HALF", 0);
-                    codeGenerator.emit("STORE", 2);
-                    codeGenerator.emit("LOAD", 1);
-                    codeGenerator.emit("HALF", 0);
-                    codeGenerator.emit("STORE", 1);
-                    codeGenerator.emit("JUMP", -18);
-
-                    if (rightValue > 0){
-                        codeGenerator.emit("LOAD", leftMemoryPosition);
-                        codeGenerator.emit("JPOS", 5);
-                        codeGenerator.emit("LOAD", 3);
-                        codeGenerator.emit("SUB", 3);
-                        codeGenerator.emit("SUB", 3);
-                        codeGenerator.emit("JUMP", 2);
-                        codeGenerator.emit("LOAD", 3);
-                    } else {
-                        codeGenerator.emit("LOAD", leftMemoryPosition);
-                        codeGenerator.emit("JNEG", 5);
-                        codeGenerator.emit("LOAD", 3);
-                        codeGenerator.emit("SUB", 3);
-                        codeGenerator.emit("SUB", 3);
-                        codeGenerator.emit("JUMP", 2);
-                        codeGenerator.emit("LOAD", 3);
-                    }
-                }
-            }
-            if (op == "%"){
-                if (rightValue == 0 || rightValue == 1 || rightValue == -1){
-                    codeGenerator.emit("SUB", 0);
-                } else {  
-                    if (rightValue<0){
-                        codeGenerator.emit("SET", -rightValue);
-                        codeGenerator.emit("STORE", 1);
-                        codeGenerator.emit("STORE", 3);
-                    } else {
-                        codeGenerator.emit("SET", rightValue);
-                        codeGenerator.emit("STORE",1);
-                        codeGenerator.emit("STORE",3);
-                    }
+    void resolve(SymbolTable& symbolTable, const std::string& scope) override {
+        if (leftValue) leftValue->resolve(symbolTable, scope);
+        if (rightValue) rightValue->resolve(symbolTable, scope);
+    }
+
+    // Wynik wyrażenia trafia do result (zmiennej albo zmiennej tymczasowej)
+    void generateInto(IRBuilder& builder, IROperand result) const {
+        auto leftIdNode = nodeCast<ValueNode>(leftValue);
+        auto rightIdNode = nodeCast<ValueNode>(rightValue);
+        IROperand left = leftIdNode->generateValue(builder);
+        IROperand right = rightIdNode->generateValue(builder);
+        IROpcode opcode = IROpcode::ADD;
+        switch (op) {
+        case ArithmeticOperator::PLUS: opcode = IROpcode::ADD; break;
+        case ArithmeticOperator::MINUS: opcode = IROpcode::SUB; break;
+        case ArithmeticOperator::MULTIPLY: opcode = IROpcode::MUL; break;
+        case ArithmeticOperator::DIVIDE: opcode = IROpcode::DIV; break;
+        case ArithmeticOperator::MODULO: opcode = IROpcode::MOD; break;
+        }
+        builder.binary(opcode, result, left, right);
+    }
 
-                    codeGenerator.emit("LOAD",leftMemoryPosition);
-                    codeGenerator.emit("JZERO", 30);
-                    codeGenerator.emit("JPOS", 3);
-                    codeGenerator.emit("SUB", leftMemoryPosition);
-                    codeGenerator.emit("SUB", leftMemoryPosition);
-                    codeGenerator.emit("STORE",2 );
-
-                    codeGenerator.emit("LOAD", 2);
-                    codeGenerator.emit("SUB", 1);
-                    codeGenerator.emit("JNEG", 5);
-                    codeGenerator.emit("LOAD", 1);
-                    codeGenerator.emit("ADD", 0);
-                    codeGenerator.emit("STORE", 1);
-                    codeGenerator.emit("JUMP", -6);
-
-                    codeGenerator.emit("LOAD", 1);
-                    codeGenerator.emit("HALF", 0);
-                    codeGenerator.emit("STORE", 1);          
-
-                    codeGenerator.emit("LOAD", 2);
-                    codeGenerator.emit("SUB", 3);
-                    codeGenerator.emit("JNEG", 11);
-                    codeGenerator.emit("LOAD", 2);
-                    codeGenerator.emit("SUB", 1);
-                    codeGenerator.emit("JNEG", 4);
-                    codeGenerator.emit("LOAD", 2);
-                    codeGenerator.emit("SUB", 1);
-                    codeGenerator.emit("STORE", 2);
-                    codeGenerator.emit("LOAD", 1);
-                    codeGenerator.emit("HALF", 0);
-                    codeGenerator.emit("STORE", 1);
-                    codeGenerator.emit("JUMP", -12);
-
-                    if(rightValue>0){
-                        codeGenerator.emit("LOAD", 2);
-                    } else {
-                        codeGenerator.emit("LOAD", 2);
-                        codeGenerator.emit("SUB", 2);
-                        codeGenerator.emit("SUB", 2);
-                    }
-                }
-            }
-        } else if (!leftIdNode->isIdentifier && rightIdNode->isIdentifier) {
-            int64_t rightMemoryPosition = rightIdNode->getMemoryPosition(symbolTable, scope);
-            int64_t leftValue = leftIdNode->getValue();
-            auto rightId = rightIdNode->getIdentifierNode();
-            if(!rightId->identifierType == IdentifierNode::IdentifierType::SIMPLE){
-                rightIdNode->generateCode(codeGenerator, symbolTable, scope);
-                codeGenerator.emit("STORE", 7);
-                rightMemoryPosition = 7;
-            }
+private:
 
-            if(op == "+"){
-                codeGenerator.emit("SET", leftValue);
-                codeGenerator.emit("ADD", rightMemoryPosition);
-            }
-            if (op == "-"){
-                codeGenerator.emit("SET", leftValue);
-                codeGenerator.emit("SUB", rightMemoryPosition);
-            }
-            if (op == "*"){
-                if (leftValue==0) {
-                    codeGenerator.emit("SET", 0);
-                } else if (leftValue%2==0){
-                    codeGenerator.emit("LOAD", rightMemoryPosition);
-                    while(leftValue!=-1 && leftValue!=1){
-                        codeGenerator.emit("ADD", 0);
-                        leftValue = leftValue/2;
-                    }
-                } else {
-                    int64_t one;
-                    if(symbolTable.one){
-                        one = 0;
-                    }else {
-                        one = 1;
-                    }
-                    codeGenerator.emit("SET", leftValue);
-                    codeGenerator.emit("STORE", 1);   
-                    codeGenerator.emit("LOAD", rightMemoryPosition);
-                    codeGenerator.emit("JZERO", 35 + one);
-                    codeGenerator.emit("JPOS", 3);
-                    codeGenerator.emit("SUB", rightMemoryPosition);
-                    codeGenerator.emit("SUB", rightMemoryPosition);
-                    codeGenerator.emit("STORE", 2);
-                    codeGenerator.emit("SUB", 0);
-                    codeGenerator.emit("STORE", 3);             
-                    codeGenerator.emit("LOAD", 2);
-                    codeGenerator.emit("JPOS", 2);
-                    if (one == 1){
-                        codeGenerator.emit("JUMP", 20);
-                    } else {
-                        codeGenerator.emit("JUMP", 19);
-                    }
-                    codeGenerator.emit("HALF", 0);
-                    codeGenerator.emit("ADD", 0);
-                    codeGenerator.emit("SUB", 2);
-                    codeGenerator.emit("STORE", 5);
-                    if (symbolTable.one){
-                        codeGenerator.emit("LOAD", 10);
-                    } else {
-                        codeGenerator.emit("SET", 1);
-                        codeGenerator.emit("STORE", 10);
-                        symbolTable.one = true;
-                    }
-                    codeGenerator.emit("ADD", 5);
-                    codeGenerator.emit("JZERO", 2);
-                    codeGenerator.emit("JUMP", 4);
-                    codeGenerator.emit("LOAD", 3);
-                    codeGenerator.emit("ADD", 1);
-                    codeGenerator.emit("STORE", 3);
-                    codeGenerator.emit("LOAD", 1);
-                    codeGenerator.emit("ADD", 1);
-                    codeGenerator.emit("STORE", 1);
-                    codeGenerator.emit("LOAD", 2);
-                    codeGenerator.emit("HALF", 0);
-                    codeGenerator.emit("STORE", 2);
-                    if(one == 1){
-                        codeGenerator.emit("JUMP", -21);
-                    } else {
-                        codeGenerator.emit("JUMP", -20);
-                    }
-                    if(leftValue>0){
-                        codeGenerator.emit("LOAD", rightMemoryPosition);
-                        codeGenerator.emit("JPOS", 5);
-                        codeGenerator.emit("LOAD", 3);
-                        codeGenerator.emit("SUB", 3);
-                        codeGenerator.emit("SUB", 3);
-                        codeGenerator.emit("JUMP", 2);
-                        codeGenerator.emit("LOAD", 3);
-                    } else {
-                        codeGenerator.emit("LOAD", rightMemoryPosition);
-                        codeGenerator.emit("JPOS", 3);
-                        codeGenerator.emit("LOAD", 3);
-                        codeGenerator.emit("JUMP", 4);
-                        codeGenerator.emit("LOAD", 3);
-                        codeGenerator.emit("SUB", 3);
-                        codeGenerator.emit("SUB", 3);
-                    }
-                }
-            }
-            if (op == "/"){
-                int64_t one;
-                if(symbolTable.one){
-                    one = 0;
-                }else {
-                    one = 1;
-                }
-                if (leftValue == 0){
-                    codeGenerator.emit("SUB", 0);
-                } else if (leftValue == 1) {
-                    codeGenerator.emit("LOAD", rightMemoryPosition);
-                } else if (leftValue == -1) {
-                    codeGenerator.emit("LOAD", rightMemoryPosition);
-                    codeGenerator.emit("SUB", 0);
-                    codeGenerator.emit("SUB", rightMemoryPosition);
-                } else if (leftValue == 2) {
-                    codeGenerator.emit("LOAD", rightMemoryPosition);
-                    codeGenerator.emit("HALF", 0);
-                } else if (leftValue == -2) {
-                    codeGenerator.emit("LOAD", rightMemoryPosition);
-                    codeGenerator.emit("SUB", 0);
-                    codeGenerator.emit("SUB", rightMemoryPosition);
-                    codeGenerator.emit("HALF", 0);
-                } else { 
-
-                    codeGenerator.emit("LOAD", rightMemoryPosition);
-                    codeGenerator.emit("JZERO", 54+one);
-                    codeGenerator.emit("JPOS", 3);
-                    codeGenerator.emit("SUB", rightMemoryPosition);
-                    codeGenerator.emit("SUB", rightMemoryPosition);
-                    codeGenerator.emit("STORE",1);
-                    codeGenerator.emit("STORE",5);
-
-                    if (leftValue < 0){
-                        codeGenerator.emit("SET", -leftValue);
-                        codeGenerator.emit("STORE",4);   
-                    } else {
-                        codeGenerator.emit("SET", leftValue);
-                        codeGenerator.emit("STORE",4);
-                    }
-                    if(!symbolTable.one){
-                        codeGenerator.emit("SET", 1);
-                        codeGenerator.emit("STORE",10);
-                        symbolTable.one = true;
-                    } else {
-                        codeGenerator.emit("LOAD", 10);
-                    }
-                    codeGenerator.emit("STORE",2);
-                    codeGenerator.emit("SUB", 0);
-                    codeGenerator.emit("STORE",3);
-
-                    codeGenerator.emit("LOAD", 4);
-                    codeGenerator.emit("SUB", 1);
-                    codeGenerator.emit("JNEG", 8);
-                    codeGenerator.emit("LOAD", 1);
-                    codeGenerator.emit("ADD", 0);
-                    codeGenerator.emit("STORE", 1);
-                    codeGenerator.emit("LOAD", 2);
-                    codeGenerator.emit("ADD", 0);
-                    codeGenerator.emit("STORE", 2);
-                    codeGenerator.emit("JUMP", -9);
-
-                    codeGenerator.emit("LOAD", 2);
-                    codeGenerator.emit("HALF", 0);
-                    codeGenerator.emit("STORE", 2);
-
-                    codeGenerator.emit("LOAD", 1);
-                    codeGenerator.emit("HALF", 0);
-                    codeGenerator.emit("STORE", 1);
-                    
-                    codeGenerator.emit("LOAD", 4);
-                    codeGenerator.emit("SUB", 5);
-                    codeGenerator.emit("JNEG", 17);
-                    codeGenerator.emit("LOAD", 4);
-                    codeGenerator.emit("SUB", 1);
-                    codeGenerator.emit("JNEG", 7);
-                    codeGenerator.emit("LOAD", 4);
-                    codeGenerator.emit("SUB", 1);
-                    codeGenerator.emit("STORE", 4);
-                    codeGenerator.emit("LOAD", 3);
-                    codeGenerator.emit("ADD", 2);
-                    codeGenerator.emit("STORE", 3);
-
-                    codeGenerator.emit("LOAD", 2);
-                    codeGenerator.emit("HALF", 0);
-                    codeGenerator.emit("STORE", 2);
-                    codeGenerator.emit("LOAD", 1);
-                    codeGenerator.emit("HALF", 0);
-                    codeGenerator.emit("STORE", 1);
-                    codeGenerator.emit("JUMP", -18);
-
-                    if ( leftValue > 0){
-                        codeGenerator.emit("LOAD", rightMemoryPosition);
-                        codeGenerator.emit("JPOS", 5);
-                        codeGenerator.emit("LOAD", 3);
-                        codeGenerator.emit("SUB", 3);
-                        codeGenerator.emit("SUB", 3);
-                        codeGenerator.emit("JUMP", 2);
-                        codeGenerator.emit("LOAD", 3);
-                    } else {
-                        codeGenerator.emit("LOAD", rightMemoryPosition);
-                        codeGenerator.emit("JNEG", 5);
-                        codeGenerator.emit("LOAD", 3);
-                        codeGenerator.emit("SUB", 3);
-                        codeGenerator.emit("SUB", 3);
-                        codeGenerator.emit("JUMP", 2);
-                        codeGenerator.emit("LOAD", 3);
-                    }
-                }
-            }
-            if (op == "%"){
-                if (leftValue == 0){
-                    codeGenerator.emit("SET", 0);
-                } else {
-                    codeGenerator.emit("LOAD", rightMemoryPosition);
-                    codeGenerator.emit("JZERO", 39);
-                    codeGenerator.emit("JPOS", 3);
-                    codeGenerator.emit("SUB", rightMemoryPosition);
-                    codeGenerator.emit("SUB", rightMemoryPosition);
-                    codeGenerator.emit("STORE",3);
-                    codeGenerator.emit("STORE",1);
-
-                    if ( leftValue<0){
-                        codeGenerator.emit("SET", -leftValue);
-                        codeGenerator.emit("STORE",2);   
-                    } else {
-                        codeGenerator.emit("SET", leftValue);
-                        codeGenerator.emit("STORE",2);
-                    }
+    ASTNode* leftValue;
+    ArithmeticOperator op;
+    ASTNode* rightValue;
+};
 
-                    codeGenerator.emit("LOAD", 2);
-                    codeGenerator.emit("SUB", 1);
-                    codeGenerator.emit("JNEG", 5);
-                    codeGenerator.emit("LOAD", 1);
-                    codeGenerator.emit("ADD", 0);
-                    codeGenerator.emit("STORE", 1);
-                    codeGenerator.emit("JUMP", -6);
-
-                    codeGenerator.emit("LOAD", 1);
-                    codeGenerator.emit("HALF", 0);
-                    codeGenerator.emit("STORE", 1);          
-
-                    codeGenerator.emit("LOAD", 2);
-                    codeGenerator.emit("SUB", 3);
-                    codeGenerator.emit("JNEG", 11);
-                    codeGenerator.emit("LOAD", 2);
-                    codeGenerator.emit("SUB", 1);
-                    codeGenerator.emit("JNEG", 4);
-                    codeGenerator.emit("LOAD", 2);
-                    codeGenerator.emit("SUB", 1);
-                    codeGenerator.emit("STORE", 2);
-                    codeGenerator.emit("LOAD", 1);
-                    codeGenerator.emit("HALF", 0);
-                    codeGenerator.emit("STORE", 1);
-                    codeGenerator.emit("JUMP", -12);
-
-                    codeGenerator.emit("LOAD", rightMemoryPosition);
-                    codeGenerator.emit("JPOS", 5);
-                    codeGenerator.emit("LOAD", 2);
-                    codeGenerator.emit("SUB", 2);
-                    codeGenerator.emit("SUB", 2);
-                    codeGenerator.emit("JUMP", 2);
-                    codeGenerator.emit("LOAD", 2);
-                }
-            }
+class ConditionNode : public ASTNode {
+public:
+    static constexpr Kind KIND = Kind::CONDITION;
 
-        } else {
-            int64_t leftValue = leftIdNode->getValue();
-            int64_t rightValue = rightIdNode->getValue();
-
-            if(op == "+"){
-                if(leftValue-rightValue==0){
-                    codeGenerator.emit("SUB", 0);
-                } else {
-                    codeGenerator.emit("SET", leftValue + rightValue);
-                }
-            }
-            if (op == "-"){
-                if (leftValue-rightValue==0){
-                    codeGenerator.emit("SUB", 0);
-                } else {
-                    codeGenerator.emit("SET", leftValue - rightValue);
-                }
-            }
-            if (op == "*"){
-                if (leftValue*rightValue==0){
-                    codeGenerator.emit("SUB", 0);
-                } else {
-                    codeGenerator.emit("SET", leftValue * rightValue);
-                }
-            }
-            if (op == "/"){
-                if (rightValue == 0){
-                    codeGenerator.emit("SUB", 0);
-                } else if (rightValue < 0 && leftValue > 0 && leftValue / rightValue > 0) {
-                    codeGenerator.emit("SET", -(leftValue / rightValue));
-                }else{
-                    codeGenerator.emit("SET", leftValue / rightValue);
-                }
-            }
-            if (op == "%"){
-                if (rightValue == 0){
-                    codeGenerator.emit("SUB", 0);
-                } else if (leftValue % rightValue != 0 && ((rightValue<0) != (leftValue%rightValue<0))){
-                    codeGenerator.emit("SET", (leftValue % rightValue)+rightValue);
-                } else {
-                    codeGenerator.emit("SET", leftValue % rightValue);
-                }
+    ConditionNode(ASTNode* leftValue, RelationalOperator op, ASTNode* rightValue)
+        : ASTNode(KIND), leftValue(leftValue), op(op), rightValue(rightValue) {}
 
-            }
+    void print(int indent = 0) const override {
+        printIndent(indent);
+        std::cout << "ConditionNode\n";
+        printIndent(indent + 1);
+        std::cout << "LeftValue:\n";
+        if (leftValue) {
+            leftValue->print(indent + 2);  
         }
+        printIndent(indent + 1);
+        std::cout << "Operator: " << operatorSymbol(op) << "\n";
+        printIndent(indent + 1);
+        std::cout << "RightValue:\n";
+        if (rightValue) {
+            rightValue->print(indent + 2);
+        }
+    }
+    
+    void traverseAndAnalyze(SymbolTable& symbolTable, const std::string& scope) const override {
+        if (leftValue) leftValue->traverseAndAnalyze(symbolTable, scope);
+        if (rightValue) rightValue->traverseAndAnalyze(symbolTable, scope);
     }
 
+    void resolve(SymbolTable& symbolTable, const std::string& scope) override {
+        if (leftValue) leftValue->resolve(symbolTable, scope);
+        if (rightValue) rightValue->resolve(symbolTable, scope);
+    }
+
+    void generateBranch(IRBuilder& builder, int64_t trueBlock, int64_t falseBlock) const {
+        auto leftVal = nodeCast<ValueNode>(leftValue);
+        auto rightVal = nodeCast<ValueNode>(rightValue);
+        IROperand left = leftVal->generateValue(builder);
+        IROperand right = rightVal->generateValue(builder);
+        IRCondition condition = IRCondition::EQ;
+        switch (op) {
+        case RelationalOperator::EQUAL: condition = IRCondition::EQ; break;
+        case RelationalOperator::NOTEQUAL: condition = IRCondition::NE; break;
+        case RelationalOperator::GREATER: condition = IRCondition::GT; break;
+        case RelationalOperator::LESS: condition = IRCondition::LT; break;
+        case RelationalOperator::GREATEREQUAL: condition = IRCondition::GE; break;
+        case RelationalOperator::LESSEQUAL: condition = IRCondition::LE; break;
+        }
+        builder.branch(condition, left, right, trueBlock, falseBlock);
+    }
+    RelationalOperator getOp() const {
+        return op;
+    }
 private:
-    std::unique_ptr<ASTNode> leftValue;
-    std::string op;
-    std::unique_ptr<ASTNode> rightValue;
+    ASTNode* leftValue;
+    RelationalOperator op;
+    ASTNode* rightValue;
 };
 
 class AssignmentNode : public ASTNode {
 public:
-    AssignmentNode(std::unique_ptr<ASTNode> identifier, std::unique_ptr<ASTNode> expression)
-        : identifier(std::move(identifier)), expression(std::move(expression)) {}
+    static constexpr Kind KIND = Kind::ASSIGNMENT;
+
+    AssignmentNode(ASTNode* identifier, ASTNode* expression)
+        : ASTNode(KIND), identifier(identifier), expression(expression) {}
   
     void print(int indent = 0) const override {
         printIndent(indent);
@@ -1395,7 +808,7 @@ public:
     
     void traverseAndAnalyze(SymbolTable& symbolTable, const std::string& scope) const override {
         if (identifier) {
-            auto idNode = dynamic_cast<IdentifierNode*>(identifier.get());
+            auto idNode = nodeCast<IdentifierNode>(identifier);
             if (idNode) {
                 std::string pidentifier = idNode->getPidentifier();
                 if(pidentifier == symbolTable.iterator && pidentifier != ""){
@@ -1407,14 +820,14 @@ public:
         if (expression) expression->traverseAndAnalyze(symbolTable, scope);
 
         if (expression && identifier) {
-            auto idNode = dynamic_cast<IdentifierNode*>(identifier.get());
-            auto exprNode = dynamic_cast<ExpressionNode*>(expression.get());
+            auto idNode = nodeCast<IdentifierNode>(identifier);
+            auto exprNode = nodeCast<ExpressionNode>(expression);
             if (exprNode && idNode) {
                 if(exprNode->isVariablesInitialized(symbolTable, scope)){
                     idNode->setInitialized(symbolTable, scope);
                 }
             }
-            auto exprNode2 = dynamic_cast<ValueNode*>(expression.get());
+            auto exprNode2 = nodeCast<ValueNode>(expression);
             if (exprNode2 && idNode){
                 if(exprNode2->isVariableInitialized(symbolTable, scope)){
                     idNode->setInitialized(symbolTable, scope);
@@ -1423,64 +836,47 @@ public:
         }
     }
 
-    void generateCode(CodeGenerator& codeGenerator, SymbolTable& symbolTable, const std::string& scope) const override {
-            if (identifier && expression) {
-                auto idNode = dynamic_cast<IdentifierNode*>(identifier.get());
-                int64_t memoryPosition;
-                int64_t indexMemoryPosition; 
-                bool isArgument;
-                switch(idNode->getIdentifierType()){
-                    case IdentifierNode::IdentifierType::SIMPLE:
-                        expression->generateCode(codeGenerator, symbolTable, scope);
-                        codeGenerator.emit("STORE", idNode->getMemoryPosition(symbolTable, scope));
-                        break;
-                    case IdentifierNode::IdentifierType::INDEXED_NUM:
-                        isArgument = symbolTable.getArray(idNode->getPidentifier(), scope)->isArgument;
-                        if (!isArgument){
-                            expression->generateCode(codeGenerator, symbolTable, scope);
-                            codeGenerator.emit("STORE", idNode->getMemoryPosition(symbolTable, scope));
-                        } else{
-                            memoryPosition = symbolTable.getArray(idNode->getPidentifier(), scope)->memoryPosition;
-                            codeGenerator.emit("SET", idNode->getIndex());
-                            codeGenerator.emit("ADD", memoryPosition);
-                            codeGenerator.emit("STORE", 8);
-                            expression->generateCode(codeGenerator, symbolTable, scope);
-                            codeGenerator.emit("STOREI", 8);
-                        }
-                        
-                        break;
-                    case IdentifierNode::IdentifierType::INDEXED_ID:
-                        isArgument = symbolTable.getArray(idNode->getPidentifier(), scope)->isArgument; 
-                        if (!isArgument){
-                            memoryPosition = symbolTable.getArray(idNode->getPidentifier(), scope)->memoryPosition;
-                            indexMemoryPosition = symbolTable.getVariable(idNode->getIndexIdentifier(),scope)->memoryPosition;
-                            codeGenerator.emit("SET", memoryPosition);
-                            codeGenerator.emit("ADD", indexMemoryPosition);
-                            codeGenerator.emit("STORE", 8);
-                            expression->generateCode(codeGenerator, symbolTable, scope);
-                            codeGenerator.emit("STOREI", 8);
-                        } else {
-                            memoryPosition = symbolTable.getArray(idNode->getPidentifier(), scope)->memoryPosition;
-                            indexMemoryPosition = symbolTable.getVariable(idNode->getIndexIdentifier(),scope)->memoryPosition;
-                            codeGenerator.emit("LOAD", memoryPosition);
-                            codeGenerator.emit("ADD", indexMemoryPosition);
-                            codeGenerator.emit("STORE", 8);
-                            expression->generateCode(codeGenerator, symbolTable, scope);
-                            codeGenerator.emit("STOREI", 8);
-                        }
-                        break;
-                }
+    void resolve(SymbolTable& symbolTable, const std::string& scope) override {
+        if (identifier) identifier->resolve(symbolTable, scope);
+        if (expression) expression->resolve(symbolTable, scope);
+    }
+
+    void generateIR(IRBuilder& builder) const override {
+        if (identifier && expression) {
+            auto idNode = nodeCast<IdentifierNode>(identifier);
+            if (idNode->hasDirectCell()) {
+                generateExpression(builder, IROperand::cell(idNode->getMemoryPosition()));
+            } else {
+                IROperand address = idNode->generateAddress(builder);
+                IROperand value = builder.newTemp();
+                generateExpression(builder, value);
+                builder.store(address, value);
             }
+        }
     }
 private:
-    std::unique_ptr<ASTNode> identifier;
-    std::unique_ptr<ASTNode> expression;
+    void generateExpression(IRBuilder& builder, IROperand result) const {
+        auto exprNode = nodeCast<ExpressionNode>(expression);
+        if (exprNode) {
+            exprNode->generateInto(builder, result);
+            return;
+        }
+        auto valueNode = nodeCast<ValueNode>(expression);
+        if (valueNode) {
+            builder.copy(result, valueNode->generateValue(builder));
+        }
+    }
+
+    ASTNode* identifier;
+    ASTNode* expression;
 };
 
 class IfNode : public ASTNode {
 public:
-    IfNode(std::unique_ptr<ASTNode> condition, std::unique_ptr<ASTNode> truecommands, std::unique_ptr<ASTNode> falsecommands) 
-        : condition(std::move(condition)), truecommands(std::move(truecommands)), falsecommands(std::move(falsecommands)) {}
+    static constexpr Kind KIND = Kind::IF;
+
+    IfNode(ASTNode* condition, ASTNode* truecommands, ASTNode* falsecommands) 
+        : ASTNode(KIND), condition(condition), truecommands(truecommands), falsecommands(falsecommands) {}
     
     void print(int indent = 0) const override {
         printIndent(indent);
@@ -1500,70 +896,41 @@ public:
         if (falsecommands) falsecommands->traverseAndAnalyze(symbolTable, scope);
     }
 
-    void generateCode(CodeGenerator& codeGenerator, SymbolTable& symbolTable, const std::string& scope) const override {
-        if (condition && truecommands && falsecommands){
-            condition->generateCode(codeGenerator, symbolTable, scope);
-            int64_t jump = codeGenerator.getCurrentLine()-1;
-            command cond = codeGenerator.getCommand(jump);
-            if (cond.arg == 1){
-                falsecommands->generateCode(codeGenerator, symbolTable, scope); 
-                int64_t jump2 = codeGenerator.getCurrentLine();
-
-                codeGenerator.updateCommand(jump, cond.code, jump2-jump+1);
-                codeGenerator.emit("JUMP", 0);
-
-                truecommands->generateCode(codeGenerator, symbolTable, scope); 
-                int64_t jump3 = codeGenerator.getCurrentLine();
-
-                cond = codeGenerator.getCommand(jump2);
-                codeGenerator.updateCommand(jump2, cond.code, jump3-jump2);
-            }
-            if (cond.arg == 2){
-                truecommands->generateCode(codeGenerator, symbolTable, scope); 
-                int64_t jump2 = codeGenerator.getCurrentLine();
-
-                codeGenerator.updateCommand(jump, cond.code, jump2-jump+1);
-                codeGenerator.emit("JUMP", 0);
-
-                falsecommands->generateCode(codeGenerator, symbolTable, scope); 
-                int64_t jump3 = codeGenerator.getCurrentLine();
+    void resolve(SymbolTable& symbolTable, const std::string& scope) override {
+        if (condition) condition->resolve(symbolTable, scope);
+        if (truecommands) truecommands->resolve(symbolTable, scope);
+        if (falsecommands) falsecommands->resolve(symbolTable, scope);
+    }
 
-                cond = codeGenerator.getCommand(jump2);
-                codeGenerator.updateCommand(jump2, cond.code, jump3-jump2);
-            }
-        } else {
-            condition->generateCode(codeGenerator, symbolTable, scope);
-            int64_t jump = codeGenerator.getCurrentLine()-1;
-            command cond = codeGenerator.getCommand(jump);
-            if (cond.arg == 1){
-                codeGenerator.emit("JUMP", 0);
-                int64_t jump2 = codeGenerator.getCurrentLine()-1;
-                truecommands->generateCode(codeGenerator, symbolTable, scope);
-
-                codeGenerator.updateCommand(jump, cond.code, jump2-jump+1);
-                ino64_t jump3 = codeGenerator.getCurrentLine();
-
-                cond = codeGenerator.getCommand(jump2);
-                codeGenerator.updateCommand(jump2, cond.code, jump3-jump2);
-            }
-            if (cond.arg == 2){
-                truecommands->generateCode(codeGenerator, symbolTable, scope); 
-                int64_t jump2 = codeGenerator.getCurrentLine();
+    void generateIR(IRBuilder& builder) const override {
+        auto conditionNode = nodeCast<ConditionNode>(condition);
+        int64_t thenBlock = builder.createBlock();
+        int64_t elseBlock = falsecommands ? builder.createBlock() : -1;
+        int64_t endBlock = builder.createBlock();
+        conditionNode->generateBranch(builder, thenBlock, falsecommands ? elseBlock : endBlock);
 
-                codeGenerator.updateCommand(jump, cond.code, jump2-jump);
-            }
+        builder.setBlock(thenBlock);
+        truecommands->generateIR(builder);
+        builder.jump(endBlock);
+        if (falsecommands) {
+            builder.setBlock(elseBlock);
+            falsecommands->generateIR(builder);
+            builder.jump(endBlock);
         }
+        builder.setBlock(endBlock);
     }
 private:
-    std::unique_ptr<ASTNode> condition;
-    std::unique_ptr<ASTNode> truecommands;
-    std::unique_ptr<ASTNode> falsecommands;
+    ASTNode* condition;
+    ASTNode* truecommands;
+    ASTNode* falsecommands;
 };
 
 class WhileNode : public ASTNode {
 public:
-    WhileNode(std::unique_ptr<ASTNode> condition, std::unique_ptr<ASTNode> commands) 
-        : condition(std::move(condition)), commands(std::move(commands)) {}
+    static constexpr Kind KIND = Kind::WHILE;
+
+    WhileNode(ASTNode* condition, ASTNode* commands) 
+        : ASTNode(KIND), condition(condition), commands(commands) {}
     
     void print(int indent = 0) const override {
         printIndent(indent);
@@ -1583,39 +950,40 @@ public:
         if (commands) commands->traverseAndAnalyze(symbolTable, scope);
     }
 
-    void generateCode(CodeGenerator& codeGenerator, SymbolTable& symbolTable, const std::string& scope) const override {
+    void resolve(SymbolTable& symbolTable, const std::string& scope) override {
+        if (condition) condition->resolve(symbolTable, scope);
+        if (commands) commands->resolve(symbolTable, scope);
+    }
+
+    void generateIR(IRBuilder& builder) const override {
         if(condition && commands){
-            int64_t jump = codeGenerator.getCurrentLine();
-            condition->generateCode(codeGenerator, symbolTable, scope);
-            int64_t jump2 = codeGenerator.getCurrentLine();
-            command cond = codeGenerator.getCommand(jump2-1);
-            if (cond.arg == 1) {
-                codeGenerator.updateCommand(jump2-1, cond.code, 2);
-                codeGenerator.emit("JUMP", 0);
-
-                commands->generateCode(codeGenerator, symbolTable, scope);
-                int64_t jump3 = codeGenerator.getCurrentLine();
-                codeGenerator.emit("JUMP", jump-jump3);
-                codeGenerator.updateCommand(jump2, "JUMP", jump3+1-jump2);
-            }
-            if (cond.arg == 2) {
-                commands->generateCode(codeGenerator, symbolTable, scope);
-                int64_t jump3 = codeGenerator.getCurrentLine();
-                codeGenerator.emit("JUMP", jump-jump3);
-                codeGenerator.updateCommand(jump2-1, cond.code, jump3+1-jump2+1);
-            }
+            // Pętla obrócona: warunek raz przed pętlą, a potem na końcu ciała,
+            // tak jak w REPEAT - obrót kosztuje jeden skok warunkowy
+            auto conditionNode = nodeCast<ConditionNode>(condition);
+            int64_t bodyBlock = builder.createBlock();
+            int64_t endBlock = builder.createBlock();
+            conditionNode->generateBranch(builder, bodyBlock, endBlock);
+
+            builder.loopDepth++;
+            builder.setBlock(bodyBlock);
+            commands->generateIR(builder);
+            conditionNode->generateBranch(builder, bodyBlock, endBlock);
+            builder.loopDepth--;
+
+            builder.setBlock(endBlock);
         }
-
     }
 private:
-    std::unique_ptr<ASTNode> condition;
-    std::unique_ptr<ASTNode> commands;
+    ASTNode* condition;
+    ASTNode* commands;
 };
 
 class RepeatNode : public ASTNode {
 public:
-    RepeatNode(std::unique_ptr<ASTNode> commands, std::unique_ptr<ASTNode> condition) 
-        : commands(std::move(commands)), condition(std::move(condition)) {}
+    static constexpr Kind KIND = Kind::REPEAT;
+
+    RepeatNode(ASTNode* commands, ASTNode* condition) 
+        : ASTNode(KIND), commands(commands), condition(condition) {}
     
     void print(int indent = 0) const override {
         printIndent(indent);
@@ -1635,38 +1003,44 @@ public:
         if (condition) condition->traverseAndAnalyze(symbolTable, scope);
     }
 
-    void generateCode(CodeGenerator& codeGenerator, SymbolTable& symbolTable, const std::string& scope) const override {
+    void resolve(SymbolTable& symbolTable, const std::string& scope) override {
+        if (commands) commands->resolve(symbolTable, scope);
+        if (condition) condition->resolve(symbolTable, scope);
+    }
+
+    void generateIR(IRBuilder& builder) const override {
         if(commands && condition){
-            int64_t jump = codeGenerator.getCurrentLine();
-            commands->generateCode(codeGenerator, symbolTable, scope);
-            condition->generateCode(codeGenerator, symbolTable, scope);
-            int64_t jump2 = codeGenerator.getCurrentLine();
-            command cond = codeGenerator.getCommand(jump2-1);
-
-            if (cond.arg == 1){
-                codeGenerator.updateCommand(jump2-1, cond.code, 2);
-                codeGenerator.emit("JUMP", jump-jump2);
-            }
-            if (cond.arg == 2){
-                codeGenerator.updateCommand(jump2-1, cond.code, jump-jump2+1);
-            }
+            auto conditionNode = nodeCast<ConditionNode>(condition);
+            int64_t bodyBlock = builder.createBlock();
+            int64_t endBlock = builder.createBlock();
+            builder.jump(bodyBlock);
+
+            builder.loopDepth++;
+            builder.setBlock(bodyBlock);
+            commands->generateIR(builder);
+            conditionNode->generateBranch(builder, endBlock, bodyBlock);
+            builder.loopDepth--;
+
+            builder.setBlock(endBlock);
         }
     }
 private:
-    std::unique_ptr<ASTNode> commands;
-    std::unique_ptr<ASTNode> condition;
+    ASTNode* commands;
+    ASTNode* condition;
 };
 
 class ForToNode : public ASTNode {
 public:
-    ForToNode(std::string pidentifier,
-              std::unique_ptr<ASTNode> fromvalue,
-              std::unique_ptr<ASTNode> tovalue,
-              std::unique_ptr<ASTNode> commands)
-        : pidentifier(pidentifier),
-          fromvalue(std::move(fromvalue)),
-          tovalue(std::move(tovalue)),
-          commands(std::move(commands)) {}
+    static constexpr Kind KIND = Kind::FOR_TO;
+
+    ForToNode(const std::string& pidentifier,
+              ASTNode* fromvalue,
+              ASTNode* tovalue,
+              ASTNode* commands)
+        : ASTNode(KIND), pidentifier(pidentifier),
+          fromvalue(fromvalue),
+          tovalue(tovalue),
+          commands(commands) {}
     
     void print(int indent = 0) const override {
         printIndent(indent);
@@ -1699,52 +1073,62 @@ public:
         symbolTable.iterator = ""; 
     }
 
-    void generateCode(CodeGenerator& codeGenerator, SymbolTable& symbolTable, const std::string& scope) const override {
-        int64_t iteratorMemoryPosition = symbolTable.getVariable(pidentifier, scope)->memoryPosition;
+    void resolve(SymbolTable& symbolTable, const std::string& scope) override {
+        iterator = SymbolHandle(*symbolTable.getVariable(pidentifier, scope));
+        if (fromvalue) fromvalue->resolve(symbolTable, scope);
+        if (tovalue) tovalue->resolve(symbolTable, scope);
+        if (commands) commands->resolve(symbolTable, scope);
+    }
 
+    void generateIR(IRBuilder& builder) const override {
         if(fromvalue && tovalue && commands){
-
-         if (!symbolTable.one){
-                codeGenerator.emit("SET", 1);
-                codeGenerator.emit("STORE", 10);
-            }
-            tovalue->generateCode(codeGenerator, symbolTable, scope);
-
-            codeGenerator.emit("ADD", 10);
-            codeGenerator.emit("STORE", 9);
-            fromvalue->generateCode(codeGenerator, symbolTable, scope);
-            codeGenerator.emit("STORE", iteratorMemoryPosition);
-            int64_t jump = codeGenerator.getCurrentLine();
-            codeGenerator.emit("SUB", 9);
-            int64_t jump2 = codeGenerator.getCurrentLine();
-            codeGenerator.emit("JZERO", 0);
-
-            commands->generateCode(codeGenerator, symbolTable, scope);
-            codeGenerator.emit("LOAD", iteratorMemoryPosition);
-            codeGenerator.emit("ADD", 10);
-            codeGenerator.emit("STORE", iteratorMemoryPosition);
-            int64_t jump3 = codeGenerator.getCurrentLine();
-            codeGenerator.emit("JUMP", jump-jump3);
-            codeGenerator.updateCommand(jump2, "JZERO", jump3-jump2+1);
+            IROperand iterator = this->iterator.cell();
+            IROperand bound = nodeCast<ValueNode>(tovalue)->generateValue(builder);
+            if (!bound.isConstant()) {
+                // Granica pętli jest ustalana przy wejściu do pętli
+                IROperand fixedBound = builder.newTemp();
+                builder.copy(fixedBound, bound);
+                bound = fixedBound;
+            }
+            builder.copy(iterator, nodeCast<ValueNode>(fromvalue)->generateValue(builder));
+
+            int64_t conditionBlock = builder.createBlock();
+            int64_t bodyBlock = builder.createBlock();
+            int64_t endBlock = builder.createBlock();
+            builder.jump(conditionBlock);
+
+            builder.loopDepth++;
+            builder.setBlock(conditionBlock);
+            builder.branch(IRCondition::LE, iterator, bound, bodyBlock, endBlock);
+            builder.setBlock(bodyBlock);
+            commands->generateIR(builder);
+            builder.binary(IROpcode::ADD, iterator, iterator, IROperand::constant(1));
+            builder.jump(conditionBlock);
+            builder.loopDepth--;
+
+            builder.setBlock(endBlock);
         }
     }
 private:
-    std::string pidentifier;
-    std::unique_ptr<ASTNode> fromvalue;
-    std::unique_ptr<ASTNode> tovalue;
-    std::unique_ptr<ASTNode> commands;
+    const std::string& pidentifier;
+    ASTNode* fromvalue;
+    ASTNode* tovalue;
+    ASTNode* commands;
+    SymbolHandle iterator;
 };
 
 class ForDownToNode : public ASTNode {
 public:
-    ForDownToNode(std::string pidentifier,
-                  std::unique_ptr<ASTNode> fromvalue,
-                  std::unique_ptr<ASTNode> downtovalue,
-                  std::unique_ptr<ASTNode> commands)
-        : pidentifier(pidentifier),
-          fromvalue(std::move(fromvalue)),
-          downtovalue(std::move(downtovalue)),
-          commands(std::move(commands)) {}
+    static constexpr Kind KIND = Kind::FOR_DOWN_TO;
+
+    ForDownToNode(const std::string& pidentifier,
+                  ASTNode* fromvalue,
+                  ASTNode* downtovalue,
+                  ASTNode* commands)
+        : ASTNode(KIND), pidentifier(pidentifier),
+          fromvalue(fromvalue),
+          downtovalue(downtovalue),
+          commands(commands) {}
     
     void print(int indent = 0) const override {
         printIndent(indent);
@@ -1777,44 +1161,55 @@ public:
         symbolTable.iterator = "";
     }
 
-    void generateCode(CodeGenerator& codeGenerator, SymbolTable& symbolTable, const std::string& scope) const override {
+    void resolve(SymbolTable& symbolTable, const std::string& scope) override {
+        iterator = SymbolHandle(*symbolTable.getVariable(pidentifier, scope));
+        if (fromvalue) fromvalue->resolve(symbolTable, scope);
+        if (downtovalue) downtovalue->resolve(symbolTable, scope);
+        if (commands) commands->resolve(symbolTable, scope);
+    }
+
+    void generateIR(IRBuilder& builder) const override {
         if(fromvalue && downtovalue && commands){
-            if (!symbolTable.one){
-                codeGenerator.emit("SET", 1);
-                codeGenerator.emit("STORE", 10);
-            }
-            downtovalue->generateCode(codeGenerator, symbolTable, scope);
-            codeGenerator.emit("SUB", 10);
-            codeGenerator.emit("STORE", 9);
-            fromvalue->generateCode(codeGenerator, symbolTable, scope);
-            codeGenerator.emit("STORE", symbolTable.getVariable(pidentifier, scope)->memoryPosition);
-            int64_t jump = codeGenerator.getCurrentLine();
-            codeGenerator.emit("SUB", 9);
-            int64_t jump2 = codeGenerator.getCurrentLine();
-            codeGenerator.emit("JZERO", 0);
-
-            commands->generateCode(codeGenerator, symbolTable, scope);
-            codeGenerator.emit("LOAD", symbolTable.getVariable(pidentifier, scope)->memoryPosition);
-            codeGenerator.emit("SUB", 10);
-            codeGenerator.emit("STORE", symbolTable.getVariable(pidentifier, scope)->memoryPosition);
-            codeGenerator.emit("LOAD", symbolTable.getVariable(pidentifier, scope)->memoryPosition);
-            int64_t jump3 = codeGenerator.getCurrentLine();
-            codeGenerator.emit("JUMP", jump-jump3);
-            codeGenerator.updateCommand(jump2, "JZERO", jump3-jump2+1);
+            IROperand iterator = this->iterator.cell();
+            IROperand bound = nodeCast<ValueNode>(downtovalue)->generateValue(builder);
+            if (!bound.isConstant()) {
+                // Granica pętli jest ustalana przy wejściu do pętli
+                IROperand fixedBound = builder.newTemp();
+                builder.copy(fixedBound, bound);
+                bound = fixedBound;
+            }
+            builder.copy(iterator, nodeCast<ValueNode>(fromvalue)->generateValue(builder));
+
+            int64_t conditionBlock = builder.createBlock();
+            int64_t bodyBlock = builder.createBlock();
+            int64_t endBlock = builder.createBlock();
+            builder.jump(conditionBlock);
+
+            builder.loopDepth++;
+            builder.setBlock(conditionBlock);
+            builder.branch(IRCondition::GE, iterator, bound, bodyBlock, endBlock);
+            builder.setBlock(bodyBlock);
+            commands->generateIR(builder);
+            builder.binary(IROpcode::SUB, iterator, iterator, IROperand::constant(1));
+            builder.jump(conditionBlock);
+            builder.loopDepth--;
+
+            builder.setBlock(endBlock);
         }
-
-    
     }
 private:
-    std::string pidentifier;
-    std::unique_ptr<ASTNode> fromvalue;
-    std::unique_ptr<ASTNode> downtovalue;
-    std::unique_ptr<ASTNode> commands;
+    const std::string& pidentifier;
+    ASTNode* fromvalue;
+    ASTNode* downtovalue;
+    ASTNode* commands;
+    SymbolHandle iterator;
 };
 
 class ProcallCommandNode : public ASTNode {
 public:
-    ProcallCommandNode(std::unique_ptr<ASTNode> proc_call) : proc_call(std::move(proc_call)) {}
+    static constexpr Kind KIND = Kind::PROCALL_COMMAND;
+
+    ProcallCommandNode(ASTNode* proc_call) : ASTNode(KIND), proc_call(proc_call) {}
     
     void print(int indent = 0) const override {
         printIndent(indent);
@@ -1829,16 +1224,22 @@ public:
         if (proc_call) proc_call->traverseAndAnalyze(symbolTable, scope);
     }
 
-    void generateCode(CodeGenerator& codeGenerator, SymbolTable& symbolTable, const std::string& scope) const override {
-        if (proc_call) proc_call->generateCode(codeGenerator, symbolTable, scope);
+    void resolve(SymbolTable& symbolTable, const std::string& scope) override {
+        if (proc_call) proc_call->resolve(symbolTable, scope);
+    }
+
+    void generateIR(IRBuilder& builder) const override {
+        if (proc_call) proc_call->generateIR(builder);
     }
 private:
-    std::unique_ptr<ASTNode> proc_call;
+    ASTNode* proc_call;
 };
 
 class ReadNode : public ASTNode {
 public:
-    ReadNode(std::unique_ptr<ASTNode> identifier) : identifier(std::move(identifier)) {}
+    static constexpr Kind KIND = Kind::READ;
+
+    ReadNode(ASTNode* identifier) : ASTNode(KIND), identifier(identifier) {}
     
     void print(int indent = 0) const override {
         printIndent(indent);
@@ -1849,7 +1250,7 @@ public:
     
     void traverseAndAnalyze(SymbolTable& symbolTable, const std::string& scope) const override {
         if(identifier){
-            auto idNode = dynamic_cast<IdentifierNode*>(identifier.get());
+            auto idNode = nodeCast<IdentifierNode>(identifier);
             if (idNode) {
                 IdentifierNode::IdentifierType idType = idNode->getIdentifierType();
                 std::string pidentifier;
@@ -1873,7 +1274,7 @@ public:
                             if(!symbolTable.arrayExists(pidentifier, scope)){
                                 throw std::runtime_error("Error: Variable " + pidentifier + " not declared in scope " + scope);
                             } else {
-                                symbolTable.getArray(pidentifier, scope)->memoryPositions[idNode->getIndex()] = true;
+                                symbolTable.getArray(pidentifier, scope)->setInitialized(idNode->getIndex());
                             }
                         }
                         break;
@@ -1885,53 +1286,32 @@ public:
         if (identifier) identifier->traverseAndAnalyze(symbolTable, scope);
     }
 
-    void generateCode(CodeGenerator& codeGenerator, SymbolTable& symbolTable, const std::string& scope) const override {
-            if (identifier) {
-                auto idNode = dynamic_cast<IdentifierNode*>(identifier.get());
-                int64_t memoryPosition;
-                int64_t indexMemoryPosition;
-                bool isArgument;
-                switch(idNode->getIdentifierType()){
-                    case IdentifierNode::IdentifierType::SIMPLE:
-                        codeGenerator.emit("GET", idNode->getMemoryPosition(symbolTable, scope));
-                        break;
-                    case IdentifierNode::IdentifierType::INDEXED_NUM:
-                        isArgument = symbolTable.getArray(idNode->getPidentifier(), scope)->isArgument;
-                        if (!isArgument){
-                            codeGenerator.emit("GET", idNode->getMemoryPosition(symbolTable, scope));
-                        } else {
-                            memoryPosition = symbolTable.getArray(idNode->getPidentifier(), scope)->memoryPosition + idNode->getIndex();
-                            codeGenerator.emit("GET", memoryPosition);
-                        }
-                        break;
-                    case IdentifierNode::IdentifierType::INDEXED_ID:
-                        isArgument = symbolTable.getArray(idNode->getPidentifier(), scope)->isArgument;
-                        if (!isArgument){
-                            identifier->generateCode(codeGenerator, symbolTable, scope);
-                            codeGenerator.emit("STORE", 6);
-                            codeGenerator.emit("GET", 0);
-                            codeGenerator.emit("STOREI", 6);
-                        } else {
-                            memoryPosition = symbolTable.getArray(idNode->getPidentifier(), scope)->memoryPosition;
-                            indexMemoryPosition = symbolTable.getVariable(idNode->getIndexIdentifier(),scope)->memoryPosition;
-                            codeGenerator.emit("LOAD", memoryPosition);
-                            codeGenerator.emit("ADD", indexMemoryPosition);
-                            codeGenerator.emit("STORE", 6);
-                            codeGenerator.emit("GET", 0);
-                            codeGenerator.emit("STOREI", 6);
-                        }
-                        break;
+    void resolve(SymbolTable& symbolTable, const std::string& scope) override {
+        if (identifier) identifier->resolve(symbolTable, scope);
+    }
 
-                }
+    void generateIR(IRBuilder& builder) const override {
+        if (identifier) {
+            auto idNode = nodeCast<IdentifierNode>(identifier);
+            if (idNode->hasDirectCell()) {
+                builder.read(IROperand::cell(idNode->getMemoryPosition()));
+            } else {
+                IROperand address = idNode->generateAddress(builder);
+                IROperand value = builder.newTemp();
+                builder.read(value);
+                builder.store(address, value);
             }
+        }
     }
 private:
-    std::unique_ptr<ASTNode> identifier;
+    ASTNode* identifier;
 };
 
 class WriteNode : public ASTNode {
 public:
-    WriteNode(std::unique_ptr<ASTNode> value) : value(std::move(value)) {}
+    static constexpr Kind KIND = Kind::WRITE;
+
+    WriteNode(ASTNode* value) : ASTNode(KIND), value(value) {}
     
     void print(int indent = 0) const override {
         printIndent(indent);
@@ -1944,57 +1324,37 @@ public:
     
     void traverseAndAnalyze(SymbolTable& symbolTable, const std::string& scope) const override {
         if (value) {
-            auto valNode = dynamic_cast<ValueNode*>(value.get());
+            auto valNode = nodeCast<ValueNode>(value);
             if (valNode && valNode->isIdentifier){
-                auto idNode = dynamic_cast<IdentifierNode*>(valNode->getIdentifierNode());
+                auto idNode = valNode->getIdentifierNode();
                 idNode->traverseAndAnalyze(symbolTable, scope);
             }
         }
         if (value) value->traverseAndAnalyze(symbolTable, scope);
     }
 
-    void generateCode(CodeGenerator& codeGenerator, SymbolTable& symbolTable, const std::string& scope) const override {
-        if (value) {
-            auto valNode = dynamic_cast<ValueNode*>(value.get());
-            if (valNode) {
-                if (valNode->isIdentifier){
-                    auto idNode = dynamic_cast<IdentifierNode*>(valNode->getIdentifierNode());
-                    bool isArgument;
-                    switch(idNode ->getIdentifierType()){
-                        case IdentifierNode::IdentifierType::SIMPLE:
-                            codeGenerator.emit("PUT", idNode->getMemoryPosition(symbolTable, scope));
-                            break;
-                        case IdentifierNode::IdentifierType::INDEXED_NUM:
-                            isArgument = symbolTable.getArray(idNode->getPidentifier(), scope)->isArgument;
-                            if (!isArgument){
-                                codeGenerator.emit("PUT", idNode->getMemoryPosition(symbolTable, scope));
-                            } else {
-                                valNode->getIdentifierNode()->generateCode(codeGenerator, symbolTable, scope);
-                                codeGenerator.emit("PUT", 0); 
-                            }
-                            break;
-                        case IdentifierNode::IdentifierType::INDEXED_ID:
-                            valNode->getIdentifierNode()->generateCode(codeGenerator, symbolTable, scope);
-                            codeGenerator.emit("PUT", 0);
-                            break;
-                    }
-                } else {
-                    codeGenerator.emit("SET", valNode->getValue());
-                    codeGenerator.emit("PUT", 0);
-                }
-            }
+    void resolve(SymbolTable& symbolTable, const std::string& scope) override {
+        if (value) value->resolve(symbolTable, scope);
+    }
+
+    void generateIR(IRBuilder& builder) const override {
+        auto valNode = nodeCast<ValueNode>(value);
+        if (valNode) {
+            builder.write(valNode->generateValue(builder));
         }
     }
 private:
-    std::unique_ptr<ASTNode> value;
+    ASTNode* value;
 };
 
 class DeclarationsNode : public ASTNode {
 public:
-    DeclarationsNode() = default;
+    static constexpr Kind KIND = Kind::DECLARATIONS;
 
-    void addDeclaration(std::unique_ptr<ASTNode> declaration) {
-        declarations.push_back(std::move(declaration));
+    DeclarationsNode() : ASTNode(KIND) {}
+
+    void addDeclaration(ASTNode* declaration) {
+        declarations.push_back(declaration);
     }
 
     void print(int indent = 0) const override {
@@ -2010,18 +1370,32 @@ public:
             declaration->traverseAndAnalyze(symbolTable, scope);
         }
     }
+
+    void resolve(SymbolTable& symbolTable, const std::string& scope) override {
+        for (const auto& declaration : declarations) {
+            declaration->resolve(symbolTable, scope);
+        }
+    }
+
+    void generateIR(IRBuilder& builder) const override {
+        for (const auto& declaration : declarations) {
+            declaration->generateIR(builder);
+        }
+    }
 private:
-    std::vector<std::unique_ptr<ASTNode>> declarations; 
+    std::vector<ASTNode*> declarations; 
 };
 
 class DeclarationNode : public ASTNode {
 public:
+    static constexpr Kind KIND = Kind::DECLARATION;
+
 
-    DeclarationNode(std::string pidentifier)
-        : pidentifier(std::move(pidentifier)), isArray(false), lowerBound(0), upperBound(0) {}
+    DeclarationNode(const std::string& pidentifier)
+        : ASTNode(KIND), pidentifier(pidentifier), isArray(false), lowerBound(0), upperBound(0) {}
 
-    DeclarationNode(std::string pidentifier, int64_t lowerBound, int64_t upperBound)
-        : pidentifier(std::move(pidentifier)), isArray(true), lowerBound(lowerBound), upperBound(upperBound) {}
+    DeclarationNode(const std::string& pidentifier, int64_t lowerBound, int64_t upperBound)
+        : ASTNode(KIND), pidentifier(pidentifier), isArray(true), lowerBound(lowerBound), upperBound(upperBound) {}
 
     void print(int indent = 0) const override {
         printIndent(indent);
@@ -2044,19 +1418,34 @@ public:
         }
     }
 
+    void resolve(SymbolTable& symbolTable, const std::string& scope) override {
+        if (isArray) {
+            first = symbolTable.getArray(pidentifier, scope)->memoryPosition;
+        }
+    }
+
+    void generateIR(IRBuilder& builder) const override {
+        if (isArray) {
+            builder.addArray(first, first + upperBound - lowerBound);
+        }
+    }
+
 private:
-    std::string pidentifier;   
+    const std::string& pidentifier;   
     bool isArray;              
     int64_t lowerBound;     
     int64_t upperBound;    
+    int64_t first = -1;
 };
 
 class ArgsdeclsNode : public ASTNode {
 public:
-    ArgsdeclsNode() = default;
+    static constexpr Kind KIND = Kind::ARGSDECLS;
+
+    ArgsdeclsNode() : ASTNode(KIND) {}
 
-    void addArgsdecl(std::unique_ptr<ASTNode> args_decl) {
-        args_decls.push_back(std::move(args_decl));
+    void addArgsdecl(ASTNode* args_decl) {
+        args_decls.push_back(args_decl);
     }
 
     void print(int indent = 0) const override {
@@ -2074,16 +1463,18 @@ public:
     }
 
 private:
-    std::vector<std::unique_ptr<ASTNode>> args_decls; 
+    std::vector<ASTNode*> args_decls; 
 };
 
 class ArgsdeclNode : public ASTNode {
 public:
-    ArgsdeclNode(std::string pidentifier)
-        : pidentifier(std::move(pidentifier)), isArray(false) {}
+    static constexpr Kind KIND = Kind::ARGSDECL;
 
-    ArgsdeclNode(std::string pidentifier, bool isArray)
-        : pidentifier(std::move(pidentifier)), isArray(isArray) {}
+    ArgsdeclNode(const std::string& pidentifier)
+        : ASTNode(KIND), pidentifier(pidentifier), isArray(false) {}
+
+    ArgsdeclNode(const std::string& pidentifier, bool isArray)
+        : ASTNode(KIND), pidentifier(pidentifier), isArray(isArray) {}
 
     void print(int indent = 0) const override {
         printIndent(indent);
@@ -2101,7 +1492,7 @@ public:
             arrayParam->array.endIndex = 0;
             symbolTable.addProcedureParam(scope,"GLOBAL",arrayParam);
             symbolTable.addArray(pidentifier, scope, 0, 0);
-            symbolTable.getArray(pidentifier, scope)->isInitialized[0] = true;
+            symbolTable.getArray(pidentifier, scope)->setInitialized(0);
             symbolTable.getArray(pidentifier, scope)->isArgument = true;
         } else {
             auto variableParam = std::make_shared<VariableParam>();
@@ -2115,16 +1506,18 @@ public:
     }
 
 private:
-    std::string pidentifier;   
+    const std::string& pidentifier;   
     bool isArray;              
 };
 
 class ArgNode : public ASTNode {
 public:
-    ArgNode(std::string pidentifier)
-        : pidentifier(std::move(pidentifier)) {}
+    static constexpr Kind KIND = Kind::ARG;
 
-    std::string getPidentifier() const {
+    ArgNode(const std::string& pidentifier)
+        : ASTNode(KIND), pidentifier(pidentifier) {}
+
+    const std::string& getPidentifier() const {
         return pidentifier;
     }
 
@@ -2146,19 +1539,21 @@ public:
         
     }
 private:
-    std::string pidentifier;              
+    const std::string& pidentifier;              
 };
 
 class ArgsNode : public ASTNode {
 public:
-    ArgsNode() = default;
+    static constexpr Kind KIND = Kind::ARGS;
 
-    const std::vector<std::unique_ptr<ASTNode>>& getArgs() const {
+    ArgsNode() : ASTNode(KIND) {}
+
+    const std::vector<ASTNode*>& getArgs() const {
         return args;
     }
 
-    void addArg(std::unique_ptr<ASTNode> arg) {
-        args.push_back(std::move(arg));
+    void addArg(ASTNode* arg) {
+        args.push_back(arg);
     }
 
     void print(int indent = 0) const override {
@@ -2176,17 +1571,19 @@ public:
     }
 
 private:
-    std::vector<std::unique_ptr<ASTNode>> args;
+    std::vector<ASTNode*> args;
 };
 
 class ProcCallNode : public ASTNode {
 public:
-    ProcCallNode(std::string pidentifier, std::unique_ptr<ASTNode> args) 
-        : pidentifier(std::move(pidentifier)), args(std::move(args)) {}
+    static constexpr Kind KIND = Kind::PROC_CALL;
+
+    ProcCallNode(const std::string& pidentifier, ASTNode* args) 
+        : ASTNode(KIND), pidentifier(pidentifier), args(args) {}
     
     std::vector<std::string> getArgsPidentifiers() const {
         std::vector<std::string> argsPidentifiers;
-        collectArgsPidentifiers(args.get(), argsPidentifiers);
+        collectArgsPidentifiers(args, argsPidentifiers);
         return argsPidentifiers;
     }
 
@@ -2211,76 +1608,70 @@ public:
         if(!symbolTable.isParamsTypeCorrect(pidentifier, scope, argsString)){
             throw std::runtime_error("Error: Incorrect type of arguments in procedure " + pidentifier + " in scope " + scope);
         }
+        symbolTable.addCall(scope, pidentifier);
         if (args) args->traverseAndAnalyze(symbolTable, scope);
     }
 
-    void generateCode(CodeGenerator& codeGenerator, SymbolTable& symbolTable, const std::string& scope) const override {
+    // Argumenty wiązane z parametrami wywoływanej procedury
+    void resolve(SymbolTable& symbolTable, const std::string& scope) override {
         std::vector<std::string> argsString = getArgsPidentifiers();
         std::vector<std::string> paramsString;
-        std::vector<std::shared_ptr<Param>> params = symbolTable.getProcedure(pidentifier, "GLOBAL")->params;
+        const Procedure* procedure = symbolTable.getProcedure(pidentifier, "GLOBAL");
+        callee = procedure->id;
+        const std::vector<std::shared_ptr<Param>>& params = procedure->params;
 
         for (const auto& param : params) {
-            auto variableParam = dynamic_cast<VariableParam*>(param.get());
-            if (variableParam) {
-                paramsString.push_back(variableParam->variable.name);
-          }
-            auto arrayParam = dynamic_cast<ArrayParam*>(param.get());
-            if (arrayParam) {
-                paramsString.push_back(arrayParam->array.name);
-            }
+            paramsString.push_back(param->name());
         }
+        bindings.clear();
         for (std::size_t i = 0; i < argsString.size(); i++) {
             if (symbolTable.variableExists(argsString[i], scope) && symbolTable.variableExists(paramsString[i], pidentifier)) {
-                auto variable = symbolTable.getVariable(argsString[i], scope);
-                auto variableParam = symbolTable.getVariable(paramsString[i], pidentifier);
-                codeGenerator.emit("LOAD", variable->memoryPosition);
-                codeGenerator.emit("STORE", variableParam->memoryPosition);
+                bindings.push_back({SymbolHandle(*symbolTable.getVariable(argsString[i], scope)),
+                                    SymbolHandle(*symbolTable.getVariable(paramsString[i], pidentifier)), false});
             } else if (symbolTable.arrayExists(argsString[i], scope) && symbolTable.arrayExists(paramsString[i], pidentifier)) {
-                auto array = symbolTable.getArray(argsString[i], scope);
-                auto arrayParam = symbolTable.getArray(paramsString[i], pidentifier);
-                bool isArgument = array->isArgument;
-                if (!isArgument){
-                    codeGenerator.emit("SET", array->memoryPosition - array->startIndex);
-                } else {
-                    codeGenerator.emit("LOAD", array->memoryPosition - array->startIndex);
-                }
-                codeGenerator.emit("STORE", arrayParam->memoryPosition);
-                arrayParam->startIndex = array->startIndex;
-                arrayParam->endIndex = array->endIndex;
+                bindings.push_back({SymbolHandle(*symbolTable.getArray(argsString[i], scope)),
+                                    SymbolHandle(*symbolTable.getArray(paramsString[i], pidentifier)), true});
             }
         }
-        
-        codeGenerator.emit("SET",codeGenerator.getCurrentLine()+3);
-        codeGenerator.emit("STORE", symbolTable.getProcedure(pidentifier, "GLOBAL")->returnVariable.memoryPosition);
-        if (symbolTable.getProcedure(pidentifier, "GLOBAL")->jumpLabel != -1){
-            codeGenerator.emit("JUMP",symbolTable.getProcedure(pidentifier, "GLOBAL")->jumpLabel-codeGenerator.getCurrentLine());
+    }
+
+    // Parametry skalarne są kopiowane do procedury i z powrotem (IN-OUT),
+    // parametr tablicowy dostaje adres elementu o indeksie 0
+    void generateIR(IRBuilder& builder) const override {
+        for (const auto& binding : bindings) {
+            builder.copy(binding.param.cell(), binding.isArray ? binding.argument.base() : binding.argument.cell());
         }
 
-        
-        for (std::size_t i = 0; i < argsString.size(); i++) {
-            if (symbolTable.variableExists(argsString[i], scope) && symbolTable.variableExists(paramsString[i], pidentifier)) {
-                auto variable = symbolTable.getVariable(argsString[i], scope);
-                auto variableParam = symbolTable.getVariable(paramsString[i], pidentifier);
-                codeGenerator.emit("LOAD", variableParam->memoryPosition);
-                codeGenerator.emit("STORE", variable->memoryPosition);
-            } 
+        builder.call(callee);
+
+        for (const auto& binding : bindings) {
+            if (!binding.isArray) {
+                builder.copy(binding.argument.cell(), binding.param.cell());
+            }
         }
-        
     }
 private:
-    std::string pidentifier;
-    std::unique_ptr<ASTNode> args;
+    struct Binding {
+        SymbolHandle argument;
+        SymbolHandle param;
+        bool isArray;
+    };
+
+    const std::string& pidentifier;
+    ASTNode* args;
+    int64_t callee = -1;
+    std::vector<Binding> bindings;
 
     void collectArgsPidentifiers(const ASTNode* node, std::vector<std::string>& pidentifiers) const {
         if (!node) return;
 
-        auto argsNode = dynamic_cast<const ArgsNode*>(node);
+        auto argsNode = nodeCast<ArgsNode>(node);
         if (argsNode) {
             for (const auto& arg : argsNode->getArgs()) {
-                collectArgsPidentifiers(arg.get(), pidentifiers);
+                collectArgsPidentifiers(arg, pidentifiers);
             }
         } else {
-            auto argNode = dynamic_cast<const ArgNode*>(node);
+            auto argNode = nodeCast<ArgNode>(node);
             if (argNode) {
                 pidentifiers.push_back(argNode->getPidentifier());
             }
@@ -2288,110 +1679,6 @@ private:
     }
 };
 
-class ConditionNode : public ASTNode {
-public:
-    ConditionNode(std::unique_ptr<ASTNode> leftValue, std::string op, std::unique_ptr<ASTNode> rightValue)
-        : leftValue(std::move(leftValue)), op(std::move(op)), rightValue(std::move(rightValue)) {}
-
-    void print(int indent = 0) const override {
-        printIndent(indent);
-        std::cout << "ConditionNode\n";
-        printIndent(indent + 1);
-        std::cout << "LeftValue:\n";
-        if (leftValue) {
-            leftValue->print(indent + 2);  
-        }
-        printIndent(indent + 1);
-        std::cout << "Operator: " << op << "\n";
-        printIndent(indent + 1);
-        std::cout << "RightValue:\n";
-        if (rightValue) {
-            rightValue->print(indent + 2);
-        }
-    }
-    
-    void traverseAndAnalyze(SymbolTable& symbolTable, const std::string& scope) const override {
-        if (leftValue) leftValue->traverseAndAnalyze(symbolTable, scope);
-        if (rightValue) rightValue->traverseAndAnalyze(symbolTable, scope);
-    }
-
-    void generateCode(CodeGenerator& codeGenerator, SymbolTable& symbolTable, const std::string& scope) const override {
-        auto leftVal = dynamic_cast<ValueNode*>(leftValue.get());
-        auto rightVal = dynamic_cast<ValueNode*>(rightValue.get());
-        if(leftVal->isIdentifier && rightVal->isIdentifier){
-            leftVal->generateCode(codeGenerator, symbolTable, scope);
-            if (rightVal->isIdentifier){
-                auto rightId = dynamic_cast<IdentifierNode*>(rightVal->getIdentifierNode());
-                switch (rightId->getIdentifierType()){
-                    case IdentifierNode::IdentifierType::SIMPLE:
-                        codeGenerator.emit("SUB", rightVal->getMemoryPosition(symbolTable, scope));
-                        break;
-                    case IdentifierNode::IdentifierType::INDEXED_NUM:
-                        codeGenerator.emit("SUB", rightVal->getMemoryPosition(symbolTable, scope));
-                        break;
-                    case IdentifierNode::IdentifierType::INDEXED_ID:
-                        codeGenerator.emit("STORE", 6);
-                        rightVal->generateCode(codeGenerator, symbolTable, scope);
-                        codeGenerator.emit("SUBI", 6);
-                        break;
-                }
-            }
-        } else if (leftVal->isIdentifier && !rightVal->isIdentifier){
-            int64_t rightValue = rightVal->getValue();
-            if ( rightValue == 0){
-                leftVal->generateCode(codeGenerator, symbolTable, scope);
-            } else {
-                codeGenerator.emit("SET", rightValue);
-                codeGenerator.emit("STORE", 1);
-                leftVal->generateCode(codeGenerator, symbolTable, scope);
-                codeGenerator.emit("SUB", 1);
-            }
-        } else if (!leftVal->isIdentifier && rightVal->isIdentifier){
-            int64_t leftValue = leftVal->getValue();
-            codeGenerator.emit("SET", leftValue);
-            auto righId = dynamic_cast<IdentifierNode*>(rightVal->getIdentifierNode());
-            switch (righId->getIdentifierType()){
-                case IdentifierNode::IdentifierType::SIMPLE:
-                    codeGenerator.emit("SUB", rightVal->getMemoryPosition(symbolTable, scope));
-                    break;
-                case IdentifierNode::IdentifierType::INDEXED_NUM:
-                    codeGenerator.emit("SUB", rightVal->getMemoryPosition(symbolTable, scope));
-                    break;
-                case IdentifierNode::IdentifierType::INDEXED_ID:
-                    codeGenerator.emit("STORE", 6);
-                    rightVal->generateCode(codeGenerator, symbolTable, scope);
-                    codeGenerator.emit("SUBI", 6);
-                    break;
-            }
-            
-        } else {
-            int64_t leftMemoryPosition = leftVal->getValue();
-            int64_t rightMemoryPosition = rightVal->getValue();
-            codeGenerator.emit("SET", leftMemoryPosition-rightMemoryPosition);
-        }
-        if(op == "="){
-            codeGenerator.emit("JZERO", 1);
-        }else if (op == "!="){
-            codeGenerator.emit("JZERO", 2);
-        } else if(op == "<"){
-            codeGenerator.emit("JNEG", 1);
-        } else if(op == ">"){
-            codeGenerator.emit("JPOS", 1);
-        } else if(op == "<="){
-            codeGenerator.emit("JPOS", 2);
-        } else if(op == ">="){
-            codeGenerator.emit("JNEG", 2);
-        }
-        
-    }
-    std::string getOp() const {
-        return op;
-    }
-private:
-    std::unique_ptr<ASTNode> leftValue;
-    std::string op;
-    std::unique_ptr<ASTNode> rightValue;
-};
 
 
 
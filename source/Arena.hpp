@@ -0,0 +1,64 @@
+#ifndef ARENA_HPP
+#define ARENA_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Alokator węzłów drzewa: obiekty są układane kolejno w dużych blokach,
+// a zwalniane wszystkie naraz (destruktory w odwrotnej kolejności tworzenia)
+class Arena {
+public:
+    Arena() = default;
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    ~Arena() {
+        clear();
+    }
+
+    template <typename T, typename... Args>
+    T* make(Args&&... args) {
+        T* object = new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+        if constexpr (!std::is_trivially_destructible_v<T>) {
+            destructors.push_back({object, [](void* pointer) { static_cast<T*>(pointer)->~T(); }});
+        }
+        return object;
+    }
+
+    void clear() {
+        for (auto it = destructors.rbegin(); it != destructors.rend(); ++it) {
+            it->second(it->first);
+        }
+        destructors.clear();
+        blocks.clear();
+        used = 0;
+        capacity = 0;
+    }
+
+private:
+    static constexpr std::size_t BLOCK_SIZE = 64 * 1024;
+
+    std::vector<std::unique_ptr<std::byte[]>> blocks;
+    std::vector<std::pair<void*, void (*)(void*)>> destructors;
+    std::size_t used = 0;
+    std::size_t capacity = 0;
+
+    // Bloki z new[] są wyrównane do __STDCPP_DEFAULT_NEW_ALIGNMENT__
+    void* allocate(std::size_t size, std::size_t alignment) {
+        std::size_t offset = (used + alignment - 1) & ~(alignment - 1);
+        if (blocks.empty() || offset + size > capacity) {
+            capacity = std::max(BLOCK_SIZE, size);
+            blocks.push_back(std::make_unique<std::byte[]>(capacity));
+            offset = 0;
+        }
+        used = offset + size;
+        return blocks.back().get() + offset;
+    }
+};
+
+#endif // ARENA_HPP
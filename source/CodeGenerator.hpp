@@ -1,3 +1,6 @@
+#ifndef CODE_GENERATOR_HPP
+#define CODE_GENERATOR_HPP
+
 #include <iostream>
 #include <vector>
 #include <string>
@@ -5,39 +8,524 @@
 #include <unordered_map>
 #include <memory>
 #include <fstream>
-
-struct command {
-    std::string code;
-    int64_t arg;
-};
-
+#include <algorithm>
+#include <optional>
+#include <unordered_set>
+#include <stdexcept>
+#include "Command.hpp"
 
 class CodeGenerator {
 public:
     CodeGenerator() : currentLine(0),labelCounter(0){}
 
+    // Etykiety: skok do etykiety zapamiętuje miejsce do poprawienia, a
+    // resolveLabels() wpisuje przesunięcia, gdy cały kod jest już na miejscu
     int64_t createLabel() {
+        labelLines.push_back(-1);
         return labelCounter++;
     }
 
+    // Etykieta wskazuje następny rozkaz. Stanu akumulatora nie zapomina -
+    // w miejscu, do którego się skacze, trzeba wywołać markLabel()
+    void placeLabel(int64_t label) {
+        labelLines[label] = currentLine;
+    }
+
+    void emitJump(const std::string& code, int64_t label) {
+        fixups.push_back({currentLine, label});
+        emit(code, 0);
+    }
+
+    void resolveLabels() {
+        for (const auto& [line, label] : fixups) {
+            if (labelLines[label] == -1) {
+                throw std::runtime_error("Jump to a label that was never placed");
+            }
+            generatedCode[line].arg = labelLines[label] - line;
+        }
+        fixups.clear();
+    }
 
     void emit(const std::string& code, int64_t arg) {
+        if (untracked == 0) {
+            if (isRedundant(code, arg)) {
+                return;
+            }
+            // Stała jest już w komórce: LOAD jest tańszy niż SET
+            if (code == "SET") {
+                int64_t cell = findConstant(arg);
+                if (cell != -1) {
+                    generatedCode.push_back(command{"LOAD", cell});
+                    currentLine++;
+                    trackValue("LOAD", cell);
+                    return;
+                }
+            }
+        }
         generatedCode.push_back(command{code, arg});
         currentLine++;
+        if (untracked == 0) {
+            trackValue(code, arg);
+        }
+    }
+
+    // Miejsce, do którego prowadzi skok: stan akumulatora i komórek jest nieznany
+    void markLabel() {
+        forgetValues();
     }
 
-    command getCommand(u_int64_t line) {
-        if(line >= generatedCode.size()){
-            return command{"", 0};
+    // Komórka, która przez cały program trzyma tę samą stałą (np. komórka 10 = 1)
+    void pinConstant(int64_t cell, int64_t value) {
+        pinnedConstants[cell] = value;
+        cellConstants[cell] = value;
+    }
+
+    bool accumulatorHolds(int64_t cell) const {
+        return accumulatorCells.count(cell) > 0;
+    }
+
+    // Wywołanie procedury biblioteki wykonawczej (mnożenie, dzielenie, modulo).
+    // Powrót odbywa się przez RTRN z komórki returnCell, tak jak w procedurach.
+    void callRoutine(const std::string& name, int64_t returnCell) {
+        UntrackedSection section(*this);
+        addressLines.push_back(currentLine);
+        emit("SET", currentLine + 3);
+        emit("STORE", returnCell);
+        emitJump("JUMP", routineLabel(name));
+    }
+
+    void defineRoutine(const std::string& name) {
+        markLabel();
+        placeLabel(routineLabel(name));
+    }
+
+    void emitMultiply(int64_t left, int64_t right, bool& one) {
+        UntrackedSection section(*this);
+        int64_t leftAbsolute = createLabel();
+        int64_t rightAbsolute = createLabel();
+        int64_t loop = createLabel();
+        int64_t halve = createLabel();
+        int64_t noBit = createLabel();
+        int64_t addBit = createLabel();
+        int64_t sign = createLabel();
+        int64_t leftPositive = createLabel();
+        int64_t negative = createLabel();
+        int64_t positive = createLabel();
+        int64_t done = createLabel();
+
+        emit("LOAD", left);
+        emitJump("JZERO", done);
+        emitJump("JPOS", leftAbsolute);
+        emit("SUB", left);
+        emit("SUB", left);
+        placeLabel(leftAbsolute);
+        emit("STORE", 1);
+        emit("LOAD", right);
+        emitJump("JZERO", done);
+        emitJump("JPOS", rightAbsolute);
+        emit("SUB", right);
+        emit("SUB", right);
+        placeLabel(rightAbsolute);
+        emit("STORE", 2);
+        emit("SUB", 0);
+        emit("STORE", 3);
+        placeLabel(loop);
+        emit("LOAD", 2);
+        emitJump("JPOS", halve);
+        emitJump("JUMP", sign);
+        placeLabel(halve);
+        emit("HALF", 0);
+        emit("ADD", 0);
+        emit("SUB", 2);
+        emit("STORE", 5);
+        if (one){
+            emit("LOAD", 10);
+        } else {
+            emit("SET", 1);
+            emit("STORE", 10);
+            one = true;
         }
-        return generatedCode[line];
+        emit("ADD", 5);
+        emitJump("JZERO", addBit);
+        emitJump("JUMP", noBit);
+        placeLabel(addBit);
+        emit("LOAD", 3);
+        emit("ADD", 1);
+        emit("STORE", 3);
+        placeLabel(noBit);
+        emit("LOAD", 1);
+        emit("ADD", 1);
+        emit("STORE", 1);
+        emit("LOAD", 2);
+        emit("HALF", 0);
+        emit("STORE", 2);
+        emitJump("JUMP", loop);
+
+        placeLabel(sign);
+        emit("LOAD", left);
+        emitJump("JPOS", leftPositive);
+        emit("LOAD", right);
+        emitJump("JNEG", positive);
+        emitJump("JUMP", negative);
+        placeLabel(leftPositive);
+        emit("LOAD", right);
+        emitJump("JPOS", positive);
+        placeLabel(negative);
+        emit("LOAD", 3);
+        emit("SUB", 3);
+        emit("SUB", 3);
+        emitJump("JUMP", done);
+        placeLabel(positive);
+        emit("LOAD", 3);
+        placeLabel(done);
     }
 
-    void updateCommand(u_int64_t line, const std::string& code, int64_t arg) {
-        if(line >= generatedCode.size()){
+    // Koszty rozkazów maszyny wirtualnej według specyfikacji
+    static int64_t instructionCost(const std::string& code) {
+        if (code == "GET" || code == "PUT") return 100;
+        if (code == "SET") return 50;
+        if (code == "LOADI" || code == "STOREI" || code == "ADDI" || code == "SUBI") return 20;
+        if (code == "LOAD" || code == "STORE" || code == "ADD" || code == "SUB" || code == "RTRN") return 10;
+        if (code == "HALF") return 5;
+        if (code == "HALT") return 0;
+        return 1;
+    }
+
+    static int64_t sequenceCost(const std::vector<command>& sequence) {
+        int64_t cost = 0;
+        for (const auto& c : sequence) {
+            cost += instructionCost(c.code);
+        }
+        return cost;
+    }
+
+    // Mnożenie przez stałą bez pętli: schemat Hornera na cyfrach stałej
+    // (ADD 0 podwaja akumulator, ADD/SUB operand dodaje cyfrę ±1).
+    // Spośród rozkładu binarnego i CSD wybierany jest tańszy.
+    void emitMultiplyByConstant(int64_t operand, int64_t constant) {
+        UntrackedSection section(*this);
+        if (constant == 0) {
+            emit("SUB", 0);
             return;
         }
-        generatedCode[line] = command{code, arg};
+        bool negative = constant < 0;
+        uint64_t magnitude = negative ? 0 - (uint64_t)constant : (uint64_t)constant;
+
+        std::vector<int> binary;
+        for (uint64_t n = magnitude; n != 0; n >>= 1) {
+            binary.push_back((int)(n & 1));
+        }
+        std::vector<int> csd;
+        for (unsigned __int128 n = magnitude; n != 0; n >>= 1) {
+            int digit = 0;
+            if (n & 1) {
+                digit = (n & 3) == 1 ? 1 : -1;
+                n = digit == 1 ? n - 1 : n + 1;
+            }
+            csd.push_back(digit);
+        }
+
+        std::vector<command> best = multiplyChain(operand, binary, negative);
+        std::vector<command> signedChain = multiplyChain(operand, csd, negative);
+        if (sequenceCost(signedChain) < sequenceCost(best)) {
+            best = signedChain;
+        }
+        for (const auto& c : best) {
+            emit(c.code, c.arg);
+        }
+    }
+
+    // Dzielenie przez stałą. Potęgi dwójki to ciąg HALF (HALF zaokrągla w dół,
+    // więc dla dodatniego dzielnika wynik nie wymaga poprawki znaku).
+    // Pozostałe stałe dzielą |x| rozwiniętą drabiną odejmowań, a znak
+    // i zaokrąglenie w dół poprawiane są na końcu.
+    void emitDivideByConstant(int64_t operand, int64_t constant) {
+        UntrackedSection section(*this);
+        if (constant == 0) {
+            emit("SUB", 0);
+            return;
+        }
+        uint64_t magnitude = constant < 0 ? 0 - (uint64_t)constant : (uint64_t)constant;
+        if ((magnitude & (magnitude - 1)) == 0) {
+            loadSigned(operand, constant < 0);
+            for (uint64_t m = magnitude; m > 1; m >>= 1) {
+                emit("HALF", 0);
+            }
+            return;
+        }
+
+        emitConstantLadder(operand, magnitude, true);
+
+        // |x| / |c| jest w komórce 3, reszta w komórce 2
+        int64_t differentSigns = createLabel();
+        int64_t exact = createLabel();
+        int64_t done = createLabel();
+        emit("LOAD", operand);
+        emitJump(constant > 0 ? "JNEG" : "JPOS", differentSigns);
+        emit("LOAD", 3);
+        emitJump("JUMP", done);
+        placeLabel(differentSigns);
+        emit("LOAD", 2);
+        emitJump("JZERO", exact);
+        emit("SET", -1);
+        placeLabel(exact);
+        emit("SUB", 3);
+        placeLabel(done);
+    }
+
+    // Reszta z dzielenia przez stałą, ze znakiem dzielnika
+    void emitModuloByConstant(int64_t operand, int64_t constant) {
+        UntrackedSection section(*this);
+        uint64_t magnitude = constant < 0 ? 0 - (uint64_t)constant : (uint64_t)constant;
+        if (magnitude <= 1) {
+            emit("SUB", 0);
+            return;
+        }
+        if ((magnitude & (magnitude - 1)) == 0) {
+            // x - c * floor(x / c)
+            loadSigned(operand, constant < 0);
+            for (uint64_t m = magnitude; m > 1; m >>= 1) {
+                emit("HALF", 0);
+            }
+            for (uint64_t m = magnitude; m > 1; m >>= 1) {
+                emit("ADD", 0);
+            }
+            if (constant < 0) {
+                emit("ADD", operand);
+            } else {
+                emit("STORE", 1);
+                emit("LOAD", operand);
+                emit("SUB", 1);
+            }
+            return;
+        }
+
+        emitConstantLadder(operand, magnitude, false);
+
+        // |x| mod |c| jest w komórce 2
+        int64_t differentSigns = createLabel();
+        int64_t done = createLabel();
+        if (constant > 0) {
+            emit("LOAD", operand);
+            emitJump("JNEG", differentSigns);
+            emit("LOAD", 2);
+            emitJump("JUMP", done);
+            placeLabel(differentSigns);
+            emit("LOAD", 2);
+            emitJump("JZERO", done);
+            emit("SET", constant);
+            emit("SUB", 2);
+        } else {
+            emit("LOAD", operand);
+            emitJump("JPOS", differentSigns);
+            emit("SUB", 0);
+            emit("SUB", 2);
+            emitJump("JUMP", done);
+            placeLabel(differentSigns);
+            emit("LOAD", 2);
+            emitJump("JZERO", done);
+            emit("SET", constant);
+            emit("ADD", 2);
+        }
+        placeLabel(done);
+    }
+
+    void emitDivide(int64_t left, int64_t right, bool& one) {
+        UntrackedSection section(*this);
+        int64_t rightAbsolute = createLabel();
+        int64_t leftAbsolute = createLabel();
+        int64_t scaleLoop = createLabel();
+        int64_t scaled = createLabel();
+        int64_t subtractLoop = createLabel();
+        int64_t shift = createLabel();
+        int64_t sign = createLabel();
+        int64_t leftNegative = createLabel();
+        int64_t differentSigns = createLabel();
+        int64_t exact = createLabel();
+        int64_t sameSigns = createLabel();
+        int64_t done = createLabel();
+
+        emit("LOAD", right);
+        emitJump("JZERO", done);
+        emitJump("JPOS", rightAbsolute);
+        emit("SUB", right);
+        emit("SUB", right);
+        placeLabel(rightAbsolute);
+        emit("STORE",5);
+        emit("STORE",1);
+
+        emit("LOAD",left);
+        emitJump("JZERO", done);
+        emitJump("JPOS", leftAbsolute);
+        emit("SUB", left);
+        emit("SUB", left);
+        placeLabel(leftAbsolute);
+        emit("STORE",4 );
+
+        if (!one){
+            emit("SET", 1);
+            emit("STORE", 10);
+            one = true;
+        } else {
+            emit("LOAD", 10);
+        }
+        emit("STORE",2);
+
+        emit("SUB", 0);
+        emit("STORE",3);
+
+        placeLabel(scaleLoop);
+        emit("LOAD", 4);
+        emit("SUB", 1);
+        emitJump("JNEG", scaled);
+        emit("LOAD", 1);
+        emit("ADD", 0);
+        emit("STORE", 1);
+        emit("LOAD", 2);
+        emit("ADD", 0);
+        emit("STORE", 2);
+        emitJump("JUMP", scaleLoop);
+        placeLabel(scaled);
+        emit("LOAD", 2);
+        emit("HALF", 0);
+        emit("STORE", 2);
+        emit("LOAD", 1);
+        emit("HALF", 0);
+        emit("STORE", 1);
+        placeLabel(subtractLoop);
+        emit("LOAD", 4);
+        emit("SUB", 5);
+        emitJump("JNEG", sign);
+        emit("LOAD", 4);
+        emit("SUB", 1);
+        emitJump("JNEG", shift);
+        emit("LOAD", 4);
+        emit("SUB", 1);
+        emit("STORE", 4);
+        emit("LOAD", 3);
+        emit("ADD", 2);
+        emit("STORE", 3);
+        placeLabel(shift);
+        emit("LOAD", 2);
+        emit("HALF", 0);
+        emit("STORE", 2);
+        emit("LOAD", 1);
+        emit("HALF", 0);
+        emit("STORE", 1);
+        emitJump("JUMP", subtractLoop);
+
+        // Przy różnych znakach iloraz jest zaokrąglany w dół: -q albo -q-1, gdy reszta jest niezerowa
+        placeLabel(sign);
+        emit("LOAD", left);
+        emitJump("JNEG", leftNegative);
+        emit("LOAD", right);
+        emitJump("JPOS", sameSigns);
+        emitJump("JUMP", differentSigns);
+        placeLabel(leftNegative);
+        emit("LOAD", right);
+        emitJump("JNEG", sameSigns);
+        placeLabel(differentSigns);
+        emit("LOAD", 4);
+        emitJump("JZERO", exact);
+        emit("LOAD", 10);
+        placeLabel(exact);
+        emit("ADD", 3);
+        emit("STORE", 3);
+        emit("SUB", 0);
+        emit("SUB", 3);
+        emitJump("JUMP", done);
+        placeLabel(sameSigns);
+        emit("LOAD", 3);
+        placeLabel(done);
+    }
+
+    void emitModulo(int64_t left, int64_t right) {
+        UntrackedSection section(*this);
+        int64_t rightAbsolute = createLabel();
+        int64_t leftAbsolute = createLabel();
+        int64_t scaleLoop = createLabel();
+        int64_t scaled = createLabel();
+        int64_t subtractLoop = createLabel();
+        int64_t shift = createLabel();
+        int64_t sign = createLabel();
+        int64_t leftPositive = createLabel();
+        int64_t complement = createLabel();
+        int64_t divisorSign = createLabel();
+        int64_t positive = createLabel();
+        int64_t done = createLabel();
+
+        emit("LOAD", right);
+        emitJump("JZERO", done);
+        emitJump("JPOS", rightAbsolute);
+        emit("SUB", right);
+        emit("SUB", right);
+        placeLabel(rightAbsolute);
+        emit("STORE",3);
+        emit("STORE",1);
+
+        emit("LOAD",left);
+        emitJump("JZERO", done);
+        emitJump("JPOS", leftAbsolute);
+        emit("SUB", left);
+        emit("SUB", left);
+        placeLabel(leftAbsolute);
+        emit("STORE",2 );
+
+        placeLabel(scaleLoop);
+        emit("LOAD", 2);
+        emit("SUB", 1);
+        emitJump("JNEG", scaled);
+        emit("LOAD", 1);
+        emit("ADD", 0);
+        emit("STORE", 1);
+        emitJump("JUMP", scaleLoop);
+
+        placeLabel(scaled);
+        emit("LOAD", 1);
+        emit("HALF", 0);
+        emit("STORE", 1);
+
+        placeLabel(subtractLoop);
+        emit("LOAD", 2);
+        emit("SUB", 3);
+        emitJump("JNEG", sign);
+        emit("LOAD", 2);
+        emit("SUB", 1);
+        emitJump("JNEG", shift);
+        emit("LOAD", 2);
+        emit("SUB", 1);
+        emit("STORE", 2);
+        placeLabel(shift);
+        emit("LOAD", 1);
+        emit("HALF", 0);
+        emit("STORE", 1);
+        emitJump("JUMP", subtractLoop);
+
+        // Reszta ma znak dzielnika: przy różnych znakach argumentów r = |b| - r
+        placeLabel(sign);
+        emit("LOAD", 2);
+        emitJump("JZERO", done);
+        emit("LOAD", left);
+        emitJump("JPOS", leftPositive);
+        emit("LOAD", right);
+        emitJump("JPOS", complement);
+        emitJump("JUMP", divisorSign);
+        placeLabel(leftPositive);
+        emit("LOAD", right);
+        emitJump("JPOS", divisorSign);
+        placeLabel(complement);
+        emit("LOAD", 3);
+        emit("SUB", 2);
+        emit("STORE", 2);
+        placeLabel(divisorSign);
+        emit("LOAD", right);
+        emitJump("JPOS", positive);
+        emit("SUB", 0);
+        emit("SUB", 2);
+        emitJump("JUMP", done);
+        placeLabel(positive);
+        emit("LOAD", 2);
+        placeLabel(done);
     }
 
     void print() {
@@ -50,19 +538,13 @@ public:
         }
     }
     
-    void saveToFile(const std::string& filename) {
+    bool saveToFile(const std::string& filename) {
         std::ofstream file(filename);
         if (!file.is_open()) {
-            std::cerr << "Could not open file: " << filename << std::endl;
-            return;
-        }
-        for (const auto& code : generatedCode) {
-            if(code.code == "HALT" || code.code == "HALF") {
-                file << code.code << "\n";
-            } else{ 
-                file << code.code << " " << code.arg << "\n";
-            }
+            return false;
         }
+        writeCommands(file, generatedCode);
+        return true;
     }
 
     void removeLastCommand(){
@@ -77,8 +559,219 @@ public:
     std::vector<command> getGeneratedCode() const {
         return generatedCode;
     }
+
+    std::vector<command> takeGeneratedCode() {
+        return std::move(generatedCode);
+    }
+
+    // Wiersze z rozkazem SET, którego argumentem jest bezwzględny adres w kodzie (adres powrotu)
+    std::vector<u_int64_t> getAddressLines() const {
+        return addressLines;
+    }
+
+    void setGeneratedCode(const std::vector<command>& code, const std::vector<u_int64_t>& lines) {
+        generatedCode = code;
+        addressLines = lines;
+        currentLine = generatedCode.size();
+    }
 private:
+    // Sekwencje z wewnętrznymi skokami: stan akumulatora w miejscach, do
+    // których skaczą, nie jest znany, więc śledzenie wartości jest w nich wyłączone
+    struct UntrackedSection {
+        CodeGenerator& generator;
+        UntrackedSection(CodeGenerator& generator) : generator(generator) {
+            generator.forgetValues();
+            generator.untracked++;
+        }
+        ~UntrackedSection() {
+            generator.untracked--;
+            generator.forgetValues();
+        }
+    };
+
+    int64_t routineLabel(const std::string& name) {
+        auto it = routineLabels.find(name);
+        if (it == routineLabels.end()) {
+            it = routineLabels.emplace(name, createLabel()).first;
+        }
+        return it->second;
+    }
+
+    void forgetValues() {
+        accumulatorConstant.reset();
+        accumulatorCells.clear();
+        cellConstants = pinnedConstants;
+    }
+
+    int64_t findConstant(int64_t value) const {
+        int64_t found = -1;
+        for (const auto& [cell, constant] : cellConstants) {
+            if (constant == value && (found == -1 || cell < found)) {
+                found = cell;
+            }
+        }
+        return found;
+    }
+
+    bool isRedundant(const std::string& code, int64_t arg) const {
+        if (code == "SET") {
+            return accumulatorConstant && *accumulatorConstant == arg;
+        }
+        if (code == "LOAD" || code == "STORE") {
+            if (accumulatorCells.count(arg)) {
+                return true;
+            }
+            auto it = cellConstants.find(arg);
+            return it != cellConstants.end() && accumulatorConstant && *accumulatorConstant == it->second;
+        }
+        return false;
+    }
+
+    void trackValue(const std::string& code, int64_t arg) {
+        if (code == "SET") {
+            accumulatorConstant = arg;
+            accumulatorCells.clear();
+            for (const auto& [cell, constant] : cellConstants) {
+                if (constant == arg) {
+                    accumulatorCells.insert(cell);
+                }
+            }
+        } else if (code == "LOAD") {
+            accumulatorCells = {arg};
+            auto it = cellConstants.find(arg);
+            if (it != cellConstants.end()) {
+                accumulatorConstant = it->second;
+            } else {
+                accumulatorConstant.reset();
+            }
+        } else if (code == "STORE") {
+            if (accumulatorConstant) {
+                cellConstants[arg] = *accumulatorConstant;
+            } else {
+                cellConstants.erase(arg);
+            }
+            accumulatorCells.insert(arg);
+        } else if (code == "SUB" && arg == 0) {
+            trackValue("SET", 0);
+        } else if (code == "GET" && arg != 0) {
+            cellConstants.erase(arg);
+            accumulatorCells.erase(arg);
+        } else if (code == "STOREI") {
+            cellConstants = pinnedConstants;
+            accumulatorCells.clear();
+        } else if (code == "JUMP" || code == "RTRN" || code == "HALT") {
+            forgetValues();
+        } else if (code != "PUT" && code != "JPOS" && code != "JZERO" && code != "JNEG") {
+            accumulatorConstant.reset();
+            accumulatorCells.clear();
+        }
+    }
+
+    // Cyfry od najmniej znaczącej; najstarsza cyfra jest zawsze równa 1
+    static std::vector<command> multiplyChain(int64_t operand, const std::vector<int>& digits, bool negative) {
+        std::vector<command> chain;
+        if (negative) {
+            chain.push_back(command{"SUB", 0});
+            chain.push_back(command{"SUB", operand});
+        } else {
+            chain.push_back(command{"LOAD", operand});
+        }
+        for (int64_t i = (int64_t)digits.size() - 2; i >= 0; i--) {
+            chain.push_back(command{"ADD", 0});
+            if (digits[i] != 0) {
+                chain.push_back(command{(digits[i] > 0) != negative ? "ADD" : "SUB", operand});
+            }
+        }
+        return chain;
+    }
+
+    void loadSigned(int64_t operand, bool negate) {
+        if (negate) {
+            emit("SUB", 0);
+            emit("SUB", operand);
+        } else {
+            emit("LOAD", operand);
+        }
+    }
+
+    // Drabina dla stałego dzielnika: |x| trafia do komórki 2, iloraz do komórki 3.
+    // Kroki j = top..0 odejmują |c|*2^j, a liczba kroków znana jest w czasie
+    // kompilacji. Wejście do drabiny wybiera drzewo porównań przesunięte
+    // w stronę małych ilorazów, więc krótkie dzielenia nie przechodzą całej drabiny.
+    void emitConstantLadder(int64_t operand, uint64_t magnitude, bool quotient) {
+        int64_t top = 0;
+        while (top < 62 && magnitude <= ((uint64_t)INT64_MAX >> (top + 1))) {
+            top++;
+        }
+
+        int64_t positive = createLabel();
+        emit("LOAD", operand);
+        emitJump("JPOS", positive);
+        emit("SUB", 0);
+        emit("SUB", operand);
+        placeLabel(positive);
+        emit("STORE", 2);
+        if (quotient) {
+            emit("SUB", 0);
+            emit("STORE", 3);
+        }
+
+        // stepLabels[j + 1] to krok j, stepLabels[0] to koniec drabiny
+        std::vector<int64_t> stepLabels(top + 2);
+        for (auto& label : stepLabels) {
+            label = createLabel();
+        }
+        emitLadderEntry(-1, top, magnitude, stepLabels);
+
+        for (int64_t j = top; j >= 0; j--) {
+            placeLabel(stepLabels[j + 1]);
+            int64_t skip = createLabel();
+            emit("SET", -(int64_t)(magnitude << j));
+            emit("ADD", 2);
+            emitJump("JNEG", skip);
+            emit("STORE", 2);
+            if (quotient) {
+                emit("SET", (int64_t)1 << j);
+                emit("ADD", 3);
+                emit("STORE", 3);
+            }
+            placeLabel(skip);
+        }
+        placeLabel(stepLabels[0]);
+    }
+
+    // Wybiera najwyższe j z przedziału [lo, hi], dla którego |c|*2^j <= |x|
+    // (j = -1 oznacza |x| < |c|)
+    void emitLadderEntry(int64_t lo, int64_t hi, uint64_t magnitude, const std::vector<int64_t>& stepLabels) {
+        if (lo == hi) {
+            emitJump("JUMP", stepLabels[lo + 1]);
+            return;
+        }
+        int64_t mid = lo + std::max<int64_t>(1, (hi - lo + 1) / 4);
+        int64_t lower = createLabel();
+        emit("SET", -(int64_t)(magnitude << mid));
+        emit("ADD", 2);
+        emitJump("JNEG", lower);
+        emitLadderEntry(mid, hi, magnitude, stepLabels);
+        placeLabel(lower);
+        emitLadderEntry(lo, mid - 1, magnitude, stepLabels);
+    }
+
     mutable std::vector<command> generatedCode;
     u_int64_t currentLine;
     int64_t labelCounter;
-};
\ No newline at end of file
+    std::vector<int64_t> labelLines;                        // etykieta -> wiersz, -1 przed placeLabel
+    std::vector<std::pair<u_int64_t, int64_t>> fixups;     // wiersz skoku -> etykieta
+    std::unordered_map<std::string, int64_t> routineLabels;
+    std::vector<u_int64_t> addressLines;
+
+    // Śledzenie wartości: stała w akumulatorze, komórki równe akumulatorowi
+    // i komórki o znanej stałej wartości
+    int64_t untracked = 0;
+    std::optional<int64_t> accumulatorConstant;
+    std::unordered_set<int64_t> accumulatorCells;
+    std::unordered_map<int64_t, int64_t> cellConstants;
+    std::unordered_map<int64_t, int64_t> pinnedConstants;
+};
+
+#endif // CODE_GENERATOR_HPP
@@ -0,0 +1,26 @@
+#ifndef COMMAND_HPP
+#define COMMAND_HPP
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Rozkaz maszyny wirtualnej
+struct command {
+    std::string code;
+    int64_t arg;
+};
+
+// Zapis kodu w formacie pliku .mr (HALT i HALF bez argumentu)
+inline void writeCommands(std::ostream& out, const std::vector<command>& code) {
+    for (const auto& instruction : code) {
+        if (instruction.code == "HALT" || instruction.code == "HALF") {
+            out << instruction.code << "\n";
+        } else {
+            out << instruction.code << " " << instruction.arg << "\n";
+        }
+    }
+}
+
+#endif // COMMAND_HPP
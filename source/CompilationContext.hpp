@@ -0,0 +1,31 @@
+#ifndef COMPILATION_CONTEXT_HPP
+#define COMPILATION_CONTEXT_HPP
+
+#include <string>
+#include "Arena.hpp"
+#include "StringInterner.hpp"
+#include "SymbolTable.hpp"
+#include "CodeGenerator.hpp"
+#include "Diagnostics.hpp"
+
+class ASTNode;
+
+// Stan jednej kompilacji. Skaner (yyextra), parser (parametr yyparse)
+// i kolejne fazy korzystają tylko z niego, więc w jednym procesie może
+// działać wiele niezależnych kompilacji. Komunikaty o błędach są zbierane
+// w diagnostics tej kompilacji.
+struct CompilationContext {
+    CompilationContext() {
+        symbolTable.diagnostics = &diagnostics;
+    }
+
+    Diagnostics diagnostics;
+    Arena astArena;             // węzły drzewa
+    StringInterner names;       // nazwy z pidentifier
+    ASTNode* root = nullptr;
+    std::string currentLine;    // bieżący wiersz wejścia do komunikatów o błędach
+    SymbolTable symbolTable;
+    CodeGenerator codeGenerator;
+};
+
+#endif // COMPILATION_CONTEXT_HPP
@@ -0,0 +1,310 @@
+#ifndef CONSTANT_PROPAGATION_HPP
+#define CONSTANT_PROPAGATION_HPP
+
+#include <map>
+#include <set>
+#include <algorithm>
+#include <memory>
+#include <optional>
+#include <unordered_map>
+#include "IR.hpp"
+
+// Propagacja stałych i kopii w obrębie procedury (analiza przepływu danych
+// po grafie bloków). Fakt "x = v" mówi, że komórka albo zmienna tymczasowa x
+// ma wartość v: stałą albo inną komórkę/zmienną tymczasową.
+class ConstantPropagation {
+public:
+    void run(IRProgram& program) {
+        sideEffects = std::make_unique<SideEffectAnalysis>(program);
+        for (auto& function : program.functions) {
+            runFunction(function);
+            removeDeadTemps(function);
+        }
+    }
+
+private:
+    using Key = std::pair<int, int64_t>;
+    using Facts = std::map<Key, IROperand>;
+
+    std::unique_ptr<SideEffectAnalysis> sideEffects;
+
+    static Key key(const IROperand& operand) {
+        return {(int)operand.kind, operand.value};
+    }
+
+    static bool isVariable(const IROperand& operand) {
+        return operand.isCell() || operand.isTemp();
+    }
+
+    static IROperand substitute(const Facts& facts, const IROperand& operand) {
+        if (!isVariable(operand)) {
+            return operand;
+        }
+        auto it = facts.find(key(operand));
+        return it != facts.end() ? it->second : operand;
+    }
+
+    // x dostaje nową wartość: znikają fakty o x i fakty, które się na x powołują
+    static void kill(Facts& facts, const IROperand& operand) {
+        facts.erase(key(operand));
+        for (auto it = facts.begin(); it != facts.end();) {
+            if (it->second == operand) {
+                it = facts.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    // Zapis pod nieznany adres albo wywołanie procedury: nic nie wiadomo o komórkach
+    static void killCells(Facts& facts) {
+        for (auto it = facts.begin(); it != facts.end();) {
+            if (it->first.first == IROperand::CELL || it->second.isCell()) {
+                it = facts.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    static void define(Facts& facts, const IROperand& result, const IROperand& value) {
+        kill(facts, result);
+        if (value.isConstant() || (isVariable(value) && value != result)) {
+            facts[key(result)] = value;
+        }
+    }
+
+    static std::optional<int64_t> fold(IROpcode opcode, int64_t left, int64_t right) {
+        switch (opcode) {
+        case IROpcode::ADD: return (int64_t)((uint64_t)left + (uint64_t)right);
+        case IROpcode::SUB: return (int64_t)((uint64_t)left - (uint64_t)right);
+        case IROpcode::MUL: return (int64_t)((uint64_t)left * (uint64_t)right);
+        case IROpcode::DIV: return floorDivide(left, right);
+        case IROpcode::MOD: return floorModulo(left, right);
+        default: return std::nullopt;
+        }
+    }
+
+    // Stała zamiast komórki opłaca się tylko wtedy, gdy coś z niej wynika:
+    // SET kosztuje 50, a LOAD/ADD/SUB komórki 10. Stałe 0 i ±1 są tanie zawsze
+    // (SUB 0, komórka 10), a zmienna tymczasowa poza pętlą znika razem z kopią.
+    static IROperand profitable(const IROperand& original, const IROperand& value, int64_t loopDepth) {
+        if (!value.isConstant() || !isVariable(original) || value.value == 0 || value.value == 1 || value.value == -1) {
+            return value;
+        }
+        if (original.isCell() || loopDepth > 0) {
+            return original;
+        }
+        return value;
+    }
+
+    // Podstawia znane wartości w instrukcji, upraszcza ją i aktualizuje fakty
+    void transfer(Facts& facts, IRInstruction& instruction) {
+        IROperand left = substitute(facts, instruction.left);
+        IROperand right = substitute(facts, instruction.right);
+        int64_t depth = instruction.loopDepth;
+        switch (instruction.opcode) {
+        case IROpcode::COPY:
+            instruction.left = profitable(instruction.left, left, depth);
+            define(facts, instruction.result, left);
+            break;
+        case IROpcode::ADD:
+        case IROpcode::SUB:
+        case IROpcode::MUL:
+        case IROpcode::DIV:
+        case IROpcode::MOD:
+            if (left.isConstant() && right.isConstant()) {
+                int64_t value = *fold(instruction.opcode, left.value, right.value);
+                instruction = IRInstruction{IROpcode::COPY, instruction.result, IROperand::constant(value), {}, -1, depth};
+                define(facts, instruction.result, instruction.left);
+                break;
+            }
+            // Mnożenie i dzielenie przez stałą mają własne, szybkie sekwencje
+            if (instruction.opcode == IROpcode::ADD || instruction.opcode == IROpcode::SUB) {
+                instruction.left = profitable(instruction.left, left, depth);
+                instruction.right = profitable(instruction.right, right, depth);
+            } else {
+                instruction.left = left;
+                instruction.right = right;
+            }
+            kill(facts, instruction.result);
+            break;
+        case IROpcode::LOAD:
+            // Adres znany w czasie kompilacji: zwykłe odczytanie komórki
+            if (left.isConstant()) {
+                IROperand cell = IROperand::cell(left.value);
+                IROperand value = substitute(facts, cell);
+                instruction = IRInstruction{IROpcode::COPY, instruction.result, profitable(cell, value, depth), {}, -1, depth};
+                define(facts, instruction.result, value);
+            } else {
+                instruction.left = left;
+                kill(facts, instruction.result);
+            }
+            break;
+        case IROpcode::STORE: {
+            IROperand address = substitute(facts, instruction.result);
+            if (address.isConstant()) {
+                instruction = IRInstruction{IROpcode::COPY, IROperand::cell(address.value), profitable(instruction.left, left, depth), {}, -1, depth};
+                define(facts, instruction.result, left);
+            } else {
+                instruction.result = address;
+                instruction.left = profitable(instruction.left, left, depth);
+                killCells(facts);
+            }
+            break;
+        }
+        case IROpcode::READ:
+            kill(facts, instruction.result);
+            break;
+        case IROpcode::WRITE:
+            instruction.left = profitable(instruction.left, left, depth);
+            break;
+        case IROpcode::CALL: {
+            const SideEffects& effects = sideEffects->of(instruction.callee);
+            if (effects.indirectStores) {
+                killCells(facts);
+            } else {
+                for (int64_t cell : effects.cells) {
+                    kill(facts, IROperand::cell(cell));
+                }
+            }
+            break;
+        }
+        }
+    }
+
+    static Facts meet(const Facts& a, const Facts& b) {
+        Facts result;
+        for (const auto& [k, value] : a) {
+            auto it = b.find(k);
+            if (it != b.end() && it->second == value) {
+                result[k] = value;
+            }
+        }
+        return result;
+    }
+
+    std::vector<std::optional<Facts>> out;
+    std::vector<std::vector<int64_t>> feasible;
+
+    // Następniki, do których blok naprawdę może przejść: rozgałęzienie
+    // ze znanym wynikiem prowadzi tylko w jedną stronę
+    static std::vector<int64_t> feasibleSuccessors(const BasicBlock& block, const Facts& facts) {
+        if (block.terminator == IRTerminator::BRANCH) {
+            IROperand left = substitute(facts, block.left);
+            IROperand right = substitute(facts, block.right);
+            if (left.isConstant() && right.isConstant()) {
+                return {evaluateCondition(block.condition, left.value, right.value) ? block.target : block.falseTarget};
+            }
+        }
+        return block.successors();
+    }
+
+    void runFunction(IRFunction& function) {
+        size_t count = function.blocks.size();
+        std::vector<std::vector<int64_t>> predecessors = function.predecessors();
+        out.assign(count, std::nullopt);
+        feasible.assign(count, {});
+
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            for (size_t b = 0; b < count; b++) {
+                std::optional<Facts> in = entryFacts(b, predecessors);
+                if (!in) {
+                    continue;
+                }
+                Facts facts = *in;
+                BasicBlock block = function.blocks[b];
+                for (auto& instruction : block.instructions) {
+                    transfer(facts, instruction);
+                }
+                if (!out[b] || *out[b] != facts) {
+                    out[b] = facts;
+                    feasible[b] = feasibleSuccessors(block, facts);
+                    changed = true;
+                }
+            }
+        }
+
+        // Fakty są stałe, można przepisać instrukcje
+        for (size_t b = 0; b < count; b++) {
+            std::optional<Facts> in = entryFacts(b, predecessors);
+            if (!in) {
+                continue;
+            }
+            Facts facts = *in;
+            BasicBlock& block = function.blocks[b];
+            for (auto& instruction : block.instructions) {
+                transfer(facts, instruction);
+            }
+            if (block.terminator == IRTerminator::BRANCH) {
+                IROperand left = substitute(facts, block.left);
+                IROperand right = substitute(facts, block.right);
+                block.left = profitable(block.left, left, block.loopDepth);
+                block.right = profitable(block.right, right, block.loopDepth);
+                if (left.isConstant() && right.isConstant()) {
+                    bool taken = evaluateCondition(block.condition, left.value, right.value);
+                    block.terminator = IRTerminator::JUMP;
+                    block.target = taken ? block.target : block.falseTarget;
+                    block.falseTarget = -1;
+                    block.left = IROperand();
+                    block.right = IROperand();
+                }
+            }
+        }
+    }
+
+    // Blok wejściowy zaczyna bez faktów; pozostałe biorą część wspólną
+    // faktów z już przetworzonych poprzedników, które mogą do nich przejść
+    std::optional<Facts> entryFacts(size_t block, const std::vector<std::vector<int64_t>>& predecessors) const {
+        if (block == 0) {
+            return Facts();
+        }
+        std::optional<Facts> in;
+        for (int64_t predecessor : predecessors[block]) {
+            if (!out[predecessor]) {
+                continue;
+            }
+            const auto& successors = feasible[predecessor];
+            if (std::find(successors.begin(), successors.end(), (int64_t)block) == successors.end()) {
+                continue;
+            }
+            in = in ? meet(*in, *out[predecessor]) : *out[predecessor];
+        }
+        return in;
+    }
+
+    // Zmienne tymczasowe, których nikt już nie czyta, są usuwane razem z obliczeniem
+    static void removeDeadTemps(IRFunction& function) {
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            std::unordered_map<int64_t, int64_t> uses;
+            for (const auto& block : function.blocks) {
+                for (const auto& instruction : block.instructions) {
+                    for (const auto& operand : instruction.uses()) {
+                        if (operand.isTemp()) uses[operand.value]++;
+                    }
+                }
+                if (block.left.isTemp()) uses[block.left.value]++;
+                if (block.right.isTemp()) uses[block.right.value]++;
+            }
+            for (auto& block : function.blocks) {
+                std::vector<IRInstruction> kept;
+                for (const auto& instruction : block.instructions) {
+                    bool dead = instruction.definesResult() && instruction.result.isTemp()
+                        && instruction.opcode != IROpcode::READ && uses[instruction.result.value] == 0;
+                    if (dead) {
+                        changed = true;
+                    } else {
+                        kept.push_back(instruction);
+                    }
+                }
+                block.instructions = kept;
+            }
+        }
+    }
+};
+
+#endif // CONSTANT_PROPAGATION_HPP
@@ -0,0 +1,86 @@
+#ifndef DEAD_CODE_ELIMINATION_HPP
+#define DEAD_CODE_ELIMINATION_HPP
+
+#include <set>
+#include <unordered_map>
+#include "IR.hpp"
+
+// Usuwanie martwego kodu: bloków, do których nie da się dojść (np. gałąź
+// IF-a o stałym warunku, pętla, która nie wykona się ani razu) oraz procedur,
+// których nie wywołuje program główny ani żadna z wywoływanych przez niego procedur.
+class DeadCodeElimination {
+public:
+    void run(IRProgram& program) {
+        for (auto& function : program.functions) {
+            removeUnreachableBlocks(function);
+        }
+        removeUncalledProcedures(program);
+    }
+
+private:
+    static void removeUnreachableBlocks(IRFunction& function) {
+        std::vector<bool> reachable(function.blocks.size(), false);
+        std::vector<int64_t> stack = {0};
+        reachable[0] = true;
+        while (!stack.empty()) {
+            int64_t block = stack.back();
+            stack.pop_back();
+            for (int64_t successor : function.blocks[block].successors()) {
+                if (!reachable[successor]) {
+                    reachable[successor] = true;
+                    stack.push_back(successor);
+                }
+            }
+        }
+
+        std::unordered_map<int64_t, int64_t> renumber;
+        std::vector<BasicBlock> blocks;
+        for (const auto& block : function.blocks) {
+            if (reachable[block.id]) {
+                renumber[block.id] = blocks.size();
+                blocks.push_back(block);
+            }
+        }
+        for (auto& block : blocks) {
+            block.id = renumber[block.id];
+            if (block.target != -1) block.target = renumber[block.target];
+            if (block.falseTarget != -1) block.falseTarget = renumber[block.falseTarget];
+        }
+        function.blocks = blocks;
+    }
+
+    // Graf wywołań jest acykliczny (rekurencja jest zabroniona), ale przejście
+    // i tak pamięta odwiedzone procedury
+    static void removeUncalledProcedures(IRProgram& program) {
+        std::set<int64_t> called;
+        std::vector<const IRFunction*> stack;
+        for (const auto& function : program.functions) {
+            if (function.isMain) {
+                stack.push_back(&function);
+            }
+        }
+        while (!stack.empty()) {
+            const IRFunction* function = stack.back();
+            stack.pop_back();
+            for (const auto& block : function->blocks) {
+                for (const auto& instruction : block.instructions) {
+                    if (instruction.opcode == IROpcode::CALL && !called.count(instruction.callee)) {
+                        called.insert(instruction.callee);
+                        stack.push_back(program.getFunction(instruction.callee));
+                    }
+                }
+            }
+        }
+
+        std::vector<IRFunction> functions;
+        for (const auto& function : program.functions) {
+            if (function.isMain || called.count(function.id)) {
+                functions.push_back(function);
+            }
+        }
+        program.functions = functions;
+        program.reindex();
+    }
+};
+
+#endif // DEAD_CODE_ELIMINATION_HPP
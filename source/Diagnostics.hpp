@@ -0,0 +1,49 @@
+#ifndef DIAGNOSTICS_HPP
+#define DIAGNOSTICS_HPP
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Komunikat o błędzie. line = 0, gdy miejsce w źródle nie jest znane
+// (analiza semantyczna), sourceLine to wczytana dotąd część wiersza.
+struct Diagnostic {
+    int64_t line = 0;
+    std::string message;
+    std::string sourceLine;
+};
+
+// Komunikaty jednej kompilacji, w kolejności zgłoszenia
+class Diagnostics {
+public:
+    void report(std::string message, int64_t line = 0, std::string sourceLine = "") {
+        messages.push_back(Diagnostic{line, std::move(message), std::move(sourceLine)});
+    }
+
+    bool empty() const {
+        return messages.empty();
+    }
+
+    const std::vector<Diagnostic>& getMessages() const {
+        return messages;
+    }
+
+    std::vector<Diagnostic> takeMessages() {
+        return std::move(messages);
+    }
+
+    static void print(std::ostream& out, const std::vector<Diagnostic>& messages) {
+        for (const auto& diagnostic : messages) {
+            out << diagnostic.message << "\n";
+            if (diagnostic.line != 0) {
+                out << diagnostic.line << " | " << diagnostic.sourceLine << "\n";
+            }
+        }
+    }
+
+private:
+    std::vector<Diagnostic> messages;
+};
+
+#endif // DIAGNOSTICS_HPP
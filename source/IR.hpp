@@ -0,0 +1,460 @@
+#ifndef IR_HPP
+#define IR_HPP
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <set>
+#include <unordered_map>
+
+// Argument instrukcji IR: stała, komórka pamięci (zmienna, element tablicy
+// o stałym indeksie, parametr) albo zmienna tymczasowa
+struct IROperand {
+    enum Kind {
+        NONE,
+        CONSTANT,
+        CELL,
+        TEMP
+    };
+
+    Kind kind = NONE;
+    int64_t value = 0;
+
+    static IROperand constant(int64_t value) {
+        return IROperand{CONSTANT, value};
+    }
+
+    static IROperand cell(int64_t address) {
+        return IROperand{CELL, address};
+    }
+
+    static IROperand temp(int64_t id) {
+        return IROperand{TEMP, id};
+    }
+
+    bool isNone() const { return kind == NONE; }
+    bool isConstant() const { return kind == CONSTANT; }
+    bool isCell() const { return kind == CELL; }
+    bool isTemp() const { return kind == TEMP; }
+
+    bool operator==(const IROperand& other) const {
+        return kind == other.kind && value == other.value;
+    }
+
+    bool operator!=(const IROperand& other) const {
+        return !(*this == other);
+    }
+};
+
+enum class IROpcode {
+    COPY,   // result := left
+    ADD,    // result := left + right
+    SUB,    // result := left - right
+    MUL,    // result := left * right
+    DIV,    // result := left / right
+    MOD,    // result := left % right
+    LOAD,   // result := pamięć[left]
+    STORE,  // pamięć[result] := left
+    READ,   // result := wejście
+    WRITE,  // wyjście := left
+    CALL    // wywołanie procedury o identyfikatorze callee
+};
+
+struct IRInstruction {
+    IROpcode opcode;
+    IROperand result;
+    IROperand left;
+    IROperand right;
+    int64_t callee = -1;
+    int64_t loopDepth = 0;
+
+    bool isArithmetic() const {
+        return opcode == IROpcode::ADD || opcode == IROpcode::SUB || opcode == IROpcode::MUL
+            || opcode == IROpcode::DIV || opcode == IROpcode::MOD;
+    }
+
+    // Czy result jest zapisywany (STORE zapisuje pod adres, nie do result)
+    bool definesResult() const {
+        return opcode != IROpcode::STORE && opcode != IROpcode::WRITE && opcode != IROpcode::CALL;
+    }
+
+    std::vector<IROperand> uses() const {
+        std::vector<IROperand> operands;
+        if (opcode == IROpcode::STORE) {
+            operands.push_back(result);
+        }
+        if (!left.isNone()) operands.push_back(left);
+        if (!right.isNone()) operands.push_back(right);
+        return operands;
+    }
+};
+
+enum class IRTerminator {
+    JUMP,
+    BRANCH,
+    RETURN,
+    HALT
+};
+
+enum class IRCondition {
+    EQ,
+    NE,
+    LT,
+    GT,
+    LE,
+    GE
+};
+
+struct BasicBlock {
+    int64_t id = 0;
+    std::vector<IRInstruction> instructions;
+    IRTerminator terminator = IRTerminator::JUMP;
+    IRCondition condition = IRCondition::EQ;
+    IROperand left;
+    IROperand right;
+    int64_t target = -1;        // JUMP, BRANCH gdy warunek jest spełniony
+    int64_t falseTarget = -1;   // BRANCH gdy warunek nie jest spełniony
+    int64_t loopDepth = 0;
+
+    std::vector<int64_t> successors() const {
+        switch (terminator) {
+        case IRTerminator::JUMP:
+            return {target};
+        case IRTerminator::BRANCH:
+            if (target == falseTarget) {
+                return {target};
+            }
+            return {target, falseTarget};
+        default:
+            return {};
+        }
+    }
+};
+
+struct IRParameter {
+    int64_t cell;
+    bool isArray;
+};
+
+// Procedura albo program główny. Bloki leżą w kolejności rozmieszczenia w kodzie,
+// blok 0 jest blokiem wejściowym.
+struct IRFunction {
+    int64_t id = -1;                        // numer procedury w kolejności deklaracji, -1 dla programu głównego
+    std::string name;
+    bool isMain = false;
+    int64_t returnCell = -1;
+    std::vector<IRParameter> parameters;    // w kolejności deklaracji
+    std::vector<BasicBlock> blocks;
+
+    bool isParameter(const IROperand& operand) const {
+        if (!operand.isCell()) {
+            return false;
+        }
+        for (const auto& parameter : parameters) {
+            if (parameter.cell == operand.value) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    int64_t size() const {
+        int64_t count = 0;
+        for (const auto& block : blocks) {
+            count += block.instructions.size() + 1;
+        }
+        return count;
+    }
+
+    std::vector<std::vector<int64_t>> predecessors() const {
+        std::vector<std::vector<int64_t>> result(blocks.size());
+        for (const auto& block : blocks) {
+            for (int64_t successor : block.successors()) {
+                result[successor].push_back(block.id);
+            }
+        }
+        return result;
+    }
+};
+
+// Kopie argumentów do parametrów leżą tuż przed CALL (wiersze [copyIn, call)),
+// kopie wyników tuż za nim (wiersze (call, copyOut))
+struct CallCopies {
+    size_t copyIn;
+    size_t copyOut;
+};
+
+inline CallCopies findCallCopies(const BasicBlock& block, size_t call, const IRFunction& callee) {
+    CallCopies copies{call, call + 1};
+    while (copies.copyIn > 0 && block.instructions[copies.copyIn - 1].opcode == IROpcode::COPY
+           && callee.isParameter(block.instructions[copies.copyIn - 1].result)) {
+        copies.copyIn--;
+    }
+    while (copies.copyOut < block.instructions.size() && block.instructions[copies.copyOut].opcode == IROpcode::COPY
+           && callee.isParameter(block.instructions[copies.copyOut].left)) {
+        copies.copyOut++;
+    }
+    return copies;
+}
+
+struct IRProgram {
+    std::vector<IRFunction> functions;
+    int64_t tempCount = 0;
+    // Komórki, do których można się dostać przez adres (LOAD/STORE): tablice
+    std::vector<std::pair<int64_t, int64_t>> addressable;
+
+    bool isAddressable(int64_t cell) const {
+        for (const auto& [first, last] : addressable) {
+            if (cell >= first && cell <= last) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Pozycje procedur w functions według identyfikatora (-1: procedura usunięta)
+    std::vector<int64_t> positions;
+
+    IRFunction* getFunction(int64_t id) {
+        return &functions[positions[id]];
+    }
+
+    void addFunction(IRFunction function) {
+        if (function.id >= (int64_t)positions.size()) {
+            positions.resize(function.id + 1, -1);
+        }
+        if (function.id >= 0) {
+            positions[function.id] = functions.size();
+        }
+        functions.push_back(std::move(function));
+    }
+
+    // Po usunięciu procedur z functions
+    void reindex() {
+        positions.assign(positions.size(), -1);
+        for (size_t i = 0; i < functions.size(); i++) {
+            if (functions[i].id >= 0) {
+                positions[functions[i].id] = i;
+            }
+        }
+    }
+};
+
+// Komórki, które procedura (razem z wywoływanymi przez nią) może zmienić
+struct SideEffects {
+    std::set<int64_t> cells;
+    bool indirectStores = false;
+};
+
+// Rekurencja jest zabroniona, więc graf wywołań nie ma cykli
+class SideEffectAnalysis {
+public:
+    explicit SideEffectAnalysis(IRProgram& program) : program(program) {}
+
+    const SideEffects& of(int64_t id) {
+        auto it = cache.find(id);
+        if (it != cache.end()) {
+            return it->second;
+        }
+        SideEffects effects;
+        for (const auto& block : program.getFunction(id)->blocks) {
+            for (const auto& instruction : block.instructions) {
+                if (instruction.opcode == IROpcode::STORE) {
+                    effects.indirectStores = true;
+                } else if (instruction.opcode == IROpcode::CALL) {
+                    const SideEffects& callee = of(instruction.callee);
+                    effects.cells.insert(callee.cells.begin(), callee.cells.end());
+                    effects.indirectStores = effects.indirectStores || callee.indirectStores;
+                } else if (instruction.definesResult() && instruction.result.isCell()) {
+                    effects.cells.insert(instruction.result.value);
+                }
+            }
+        }
+        return cache[id] = effects;
+    }
+
+private:
+    IRProgram& program;
+    std::unordered_map<int64_t, SideEffects> cache;
+};
+
+// Dzielenie i modulo według semantyki języka: iloraz zaokrąglany w dół,
+// reszta ze znakiem dzielnika, dzielenie przez 0 daje 0. INT64_MIN / -1 nie
+// mieści się w int64_t - jak dodawanie i mnożenie przy zwijaniu stałych jest
+// liczone modulo 2^64 (wynik INT64_MIN, reszta 0), bez przepełnienia w C++
+inline int64_t floorDivide(int64_t left, int64_t right) {
+    if (right == 0) {
+        return 0;
+    }
+    if (right == -1) {
+        return (int64_t)(0 - (uint64_t)left);
+    }
+    int64_t quotient = left / right;
+    if ((left % right != 0) && ((left < 0) != (right < 0))) {
+        quotient--;
+    }
+    return quotient;
+}
+
+inline int64_t floorModulo(int64_t left, int64_t right) {
+    if (right == 0 || right == -1) {
+        return 0;
+    }
+    int64_t remainder = left % right;
+    if (remainder != 0 && ((remainder < 0) != (right < 0))) {
+        remainder += right;
+    }
+    return remainder;
+}
+
+inline bool evaluateCondition(IRCondition condition, int64_t left, int64_t right) {
+    switch (condition) {
+    case IRCondition::EQ: return left == right;
+    case IRCondition::NE: return left != right;
+    case IRCondition::LT: return left < right;
+    case IRCondition::GT: return left > right;
+    case IRCondition::LE: return left <= right;
+    case IRCondition::GE: return left >= right;
+    }
+    return false;
+}
+
+class IRBuilder {
+public:
+    int64_t loopDepth = 0;
+
+    IRBuilder(IRProgram& program) : program(program) {}
+
+    void beginFunction(int64_t id, const std::string& name, bool isMain, int64_t returnCell) {
+        pool.clear();
+        order.clear();
+        current = -1;
+        functionId = id;
+        functionName = name;
+        functionIsMain = isMain;
+        functionReturnCell = returnCell;
+        functionParameters.clear();
+        setBlock(createBlock());
+    }
+
+    void addParameter(int64_t cell, bool isArray) {
+        functionParameters.push_back(IRParameter{cell, isArray});
+    }
+
+    void addArray(int64_t first, int64_t last) {
+        program.addressable.push_back({first, last});
+    }
+
+    // Bloki dostają kolejność, w jakiej zaczęto je wypełniać, więc ciało
+    // instrukcji warunkowej czy pętli leży zaraz za blokiem z warunkiem
+    void endFunction() {
+        std::unordered_map<int64_t, int64_t> renumber;
+        for (size_t i = 0; i < order.size(); i++) {
+            renumber[order[i]] = i;
+        }
+        IRFunction function;
+        function.id = functionId;
+        function.name = functionName;
+        function.isMain = functionIsMain;
+        function.returnCell = functionReturnCell;
+        function.parameters = functionParameters;
+        for (int64_t id : order) {
+            BasicBlock block = pool[id];
+            block.id = renumber[id];
+            if (block.target != -1) block.target = renumber[block.target];
+            if (block.falseTarget != -1) block.falseTarget = renumber[block.falseTarget];
+            function.blocks.push_back(block);
+        }
+        program.addFunction(function);
+    }
+
+    int64_t createBlock() {
+        BasicBlock block;
+        block.id = pool.size();
+        pool.push_back(block);
+        return block.id;
+    }
+
+    void setBlock(int64_t id) {
+        current = id;
+        pool[id].loopDepth = loopDepth;
+        order.push_back(id);
+    }
+
+    IROperand newTemp() {
+        return IROperand::temp(program.tempCount++);
+    }
+
+    void copy(IROperand result, IROperand source) {
+        append(IRInstruction{IROpcode::COPY, result, source, {}, -1});
+    }
+
+    void binary(IROpcode opcode, IROperand result, IROperand left, IROperand right) {
+        append(IRInstruction{opcode, result, left, right, -1});
+    }
+
+    void load(IROperand result, IROperand address) {
+        append(IRInstruction{IROpcode::LOAD, result, address, {}, -1});
+    }
+
+    void store(IROperand address, IROperand value) {
+        append(IRInstruction{IROpcode::STORE, address, value, {}, -1});
+    }
+
+    void read(IROperand result) {
+        append(IRInstruction{IROpcode::READ, result, {}, {}, -1});
+    }
+
+    void write(IROperand value) {
+        append(IRInstruction{IROpcode::WRITE, {}, value, {}, -1});
+    }
+
+    void call(int64_t callee) {
+        append(IRInstruction{IROpcode::CALL, {}, {}, {}, callee});
+    }
+
+    void jump(int64_t target) {
+        pool[current].terminator = IRTerminator::JUMP;
+        pool[current].target = target;
+    }
+
+    void branch(IRCondition condition, IROperand left, IROperand right, int64_t trueTarget, int64_t falseTarget) {
+        if (left.isConstant() && right.isConstant()) {
+            jump(evaluateCondition(condition, left.value, right.value) ? trueTarget : falseTarget);
+            return;
+        }
+        BasicBlock& block = pool[current];
+        block.terminator = IRTerminator::BRANCH;
+        block.condition = condition;
+        block.left = left;
+        block.right = right;
+        block.target = trueTarget;
+        block.falseTarget = falseTarget;
+    }
+
+    void ret() {
+        pool[current].terminator = IRTerminator::RETURN;
+    }
+
+    void halt() {
+        pool[current].terminator = IRTerminator::HALT;
+    }
+
+private:
+    IRProgram& program;
+    std::vector<BasicBlock> pool;
+    std::vector<int64_t> order;
+    int64_t current = -1;
+    int64_t functionId = -1;
+    std::string functionName;
+    bool functionIsMain = false;
+    int64_t functionReturnCell = -1;
+    std::vector<IRParameter> functionParameters;
+
+    void append(IRInstruction instruction) {
+        instruction.loopDepth = loopDepth;
+        pool[current].instructions.push_back(instruction);
+    }
+};
+
+#endif // IR_HPP
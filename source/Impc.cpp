@@ -0,0 +1,85 @@
+#include "Impc.hpp"
+#include "AST.hpp"
+#include "Inliner.hpp"
+#include "ParameterPassing.hpp"
+#include "ConstantPropagation.hpp"
+#include "DeadCodeElimination.hpp"
+#include "StrengthReduction.hpp"
+#include "LoopCounters.hpp"
+#include "LoopInvariantCodeMotion.hpp"
+#include "InstructionSelector.hpp"
+#include "PeepholeOptimizer.hpp"
+#include "CompilationContext.hpp"
+
+// Skaner flex (reentrant) i parser bison (pure) - stan trzyma kontekst
+typedef void* yyscan_t;
+struct yy_buffer_state;
+extern int yylex_init_extra(CompilationContext* context, yyscan_t* scanner);
+extern yy_buffer_state* yy_scan_bytes(const char* bytes, int length, yyscan_t scanner);
+extern int yylex_destroy(yyscan_t scanner);
+extern int yyparse(yyscan_t scanner, CompilationContext& context);
+
+static bool compile(CompilationContext& context, std::string_view source) {
+    // Skaner czyta z kopii źródła we własnym buforze, usuwanym przez yylex_destroy
+    yyscan_t scanner;
+    yylex_init_extra(&context, &scanner);
+    yy_scan_bytes(source.data(), (int)source.size(), scanner);
+    int parsed = yyparse(scanner, context);
+    yylex_destroy(scanner);
+    if (parsed != 0 || !context.root) {
+        return false;
+    }
+
+    SymbolTable& symbolTable = context.symbolTable;
+    ASTNode* root = context.root;
+    try{
+        root->traverseAndAnalyze(symbolTable,"GLOBAL");
+        symbolTable.overlayFrames();
+        root->resolve(symbolTable, "GLOBAL");
+    } catch (const std::runtime_error& e) {
+        context.diagnostics.report(e.what());
+        return false;
+    }
+
+    IRProgram program;
+    IRBuilder builder(program);
+    root->generateIR(builder);
+    Inliner inliner;
+    inliner.run(program);
+    ParameterPassing parameterPassing;
+    parameterPassing.run(program);
+    ConstantPropagation propagation;
+    propagation.run(program);
+    DeadCodeElimination deadCode;
+    deadCode.run(program);
+    StrengthReduction strengthReduction;
+    strengthReduction.run(program);
+    LoopCounters loopCounters;
+    loopCounters.run(program);
+    LoopInvariantCodeMotion invariantMotion;
+    invariantMotion.run(program);
+    InstructionSelector selector(context.codeGenerator, symbolTable);
+    selector.select(program);
+    PeepholeOptimizer peephole(context.codeGenerator);
+    peephole.run();
+    return true;
+}
+
+CompilationResult compileSource(std::string_view source) {
+    CompilationResult result;
+    if (source.size() > (size_t)INT32_MAX) {
+        result.diagnostics.push_back(Diagnostic{0, "Error: source too large", ""});
+        return result;
+    }
+    CompilationContext context;
+    try {
+        result.success = compile(context, source);
+    } catch (const std::exception& e) {
+        context.diagnostics.report(e.what());
+    }
+    if (result.success) {
+        result.code = context.codeGenerator.takeGeneratedCode();
+    }
+    result.diagnostics = context.diagnostics.takeMessages();
+    return result;
+}
@@ -0,0 +1,20 @@
+#ifndef IMPC_HPP
+#define IMPC_HPP
+
+#include <string_view>
+#include <vector>
+#include "Command.hpp"
+#include "Diagnostics.hpp"
+
+// Interfejs biblioteki libimpc. Kompilacja odbywa się w pamięci: źródło
+// jest napisem, wynikiem jest kod i lista komunikatów, bez plików
+// tymczasowych. Kolejne wywołania (także z wielu wątków) są niezależne.
+struct CompilationResult {
+    bool success = false;
+    std::vector<command> code;              // pusty, gdy success == false
+    std::vector<Diagnostic> diagnostics;
+};
+
+CompilationResult compileSource(std::string_view source);
+
+#endif // IMPC_HPP
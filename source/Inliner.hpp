@@ -0,0 +1,160 @@
+#ifndef INLINER_HPP
+#define INLINER_HPP
+
+#include <set>
+#include <unordered_map>
+#include "IR.hpp"
+
+// Wstawianie procedur w miejscu wywołania. Język zabrania rekurencji, więc
+// graf wywołań nie ma cykli, a procedury leżą w programie przed swoimi
+// wywołaniami: wstawiając w kolejności deklaracji, wstawiamy ciała, w których
+// wywołania głębszych procedur są już rozwinięte.
+class Inliner {
+public:
+    // Procedura wywoływana raz jest wstawiana zawsze, mała - w każdym miejscu,
+    // większa - tylko w pętlach, gdzie narzut wywołania płacimy wielokrotnie
+    static const int64_t maxInlineSize = 40;
+    static const int64_t maxLoopInlineSize = 200;
+
+    void run(IRProgram& program) {
+        this->program = &program;
+        callSites.clear();
+        for (const auto& function : program.functions) {
+            for (const auto& block : function.blocks) {
+                for (const auto& instruction : block.instructions) {
+                    if (instruction.opcode == IROpcode::CALL) {
+                        callSites[instruction.callee]++;
+                    }
+                }
+            }
+        }
+        for (auto& function : program.functions) {
+            inlineCalls(function);
+        }
+    }
+
+private:
+    IRProgram* program = nullptr;
+    std::unordered_map<int64_t, int64_t> callSites;
+
+    bool shouldInline(const IRInstruction& call) {
+        const IRFunction* callee = program->getFunction(call.callee);
+        int64_t size = callee->size();
+        if (callSites[call.callee] == 1 || size <= maxInlineSize) {
+            return true;
+        }
+        return call.loopDepth > 0 && size <= maxLoopInlineSize;
+    }
+
+    void inlineCalls(IRFunction& function) {
+        int64_t nextId = function.blocks.size();
+        std::vector<BasicBlock> layout;
+        for (BasicBlock block : function.blocks) {
+            size_t i = 0;
+            while (i < block.instructions.size()) {
+                const IRInstruction call = block.instructions[i];
+                if (call.opcode != IROpcode::CALL || !shouldInline(call)) {
+                    i++;
+                    continue;
+                }
+                const IRFunction& callee = *program->getFunction(call.callee);
+
+                CallCopies copies = findCallCopies(block, i, callee);
+                size_t copyIn = copies.copyIn;
+                size_t copyOut = copies.copyOut;
+
+                // Parametry zastępujemy wprost komórkami argumentów, chyba że ta sama
+                // zmienna jest przekazana dwa razy - wtedy zostaje kopiowanie wartość-wynik.
+                // Adres tablicy znany w czasie kompilacji zostaje w komórce parametru:
+                // w pętli LOAD parametru jest tańszy niż SET adresu.
+                std::unordered_map<int64_t, IROperand> parameterMap;
+                std::vector<IRInstruction> keptCopies;
+                std::set<int64_t> argumentCells;
+                bool direct = true;
+                for (size_t c = copyIn; c < i; c++) {
+                    const IRInstruction& copy = block.instructions[c];
+                    if (copy.left.isConstant()) {
+                        keptCopies.push_back(copy);
+                        continue;
+                    }
+                    parameterMap[copy.result.value] = copy.left;
+                    if (!argumentCells.insert(copy.left.value).second) {
+                        direct = false;
+                    }
+                }
+                if (!direct) {
+                    parameterMap.clear();
+                    keptCopies.clear();
+                }
+
+                BasicBlock continuation = block;
+                continuation.id = nextId++;
+                continuation.instructions.clear();
+                size_t rest = direct ? copyOut : i + 1;
+                continuation.instructions.assign(block.instructions.begin() + rest, block.instructions.end());
+
+                int64_t entry = nextId;
+                nextId += callee.blocks.size();
+                block.instructions.resize(direct ? copyIn : i);
+                block.instructions.insert(block.instructions.end(), keptCopies.begin(), keptCopies.end());
+                block.terminator = IRTerminator::JUMP;
+                block.target = entry;
+                block.falseTarget = -1;
+                block.left = IROperand();
+                block.right = IROperand();
+                layout.push_back(block);
+
+                std::unordered_map<int64_t, IROperand> tempMap;
+                auto map = [&](const IROperand& operand) {
+                    if (operand.isTemp()) {
+                        auto it = tempMap.find(operand.value);
+                        if (it == tempMap.end()) {
+                            it = tempMap.emplace(operand.value, IROperand::temp(program->tempCount++)).first;
+                        }
+                        return it->second;
+                    }
+                    if (operand.isCell() && parameterMap.count(operand.value)) {
+                        return parameterMap[operand.value];
+                    }
+                    return operand;
+                };
+                for (BasicBlock clone : callee.blocks) {
+                    clone.id += entry;
+                    clone.loopDepth += call.loopDepth;
+                    if (clone.target != -1) clone.target += entry;
+                    if (clone.falseTarget != -1) clone.falseTarget += entry;
+                    if (clone.terminator == IRTerminator::RETURN) {
+                        clone.terminator = IRTerminator::JUMP;
+                        clone.target = continuation.id;
+                    }
+                    clone.left = map(clone.left);
+                    clone.right = map(clone.right);
+                    for (auto& instruction : clone.instructions) {
+                        instruction.result = map(instruction.result);
+                        instruction.left = map(instruction.left);
+                        instruction.right = map(instruction.right);
+                        instruction.loopDepth += call.loopDepth;
+                    }
+                    layout.push_back(clone);
+                }
+
+                block = continuation;
+                i = 0;
+            }
+            layout.push_back(block);
+        }
+
+        std::unordered_map<int64_t, int64_t> renumber;
+        for (size_t b = 0; b < layout.size(); b++) {
+            renumber[layout[b].id] = b;
+        }
+        for (auto& block : layout) {
+            block.id = renumber[block.id];
+            if (block.target != -1) block.target = renumber[block.target];
+            if (block.falseTarget != -1) block.falseTarget = renumber[block.falseTarget];
+        }
+        function.blocks = layout;
+    }
+};
+
+#endif // INLINER_HPP
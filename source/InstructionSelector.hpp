@@ -0,0 +1,501 @@
+#ifndef INSTRUCTION_SELECTOR_HPP
+#define INSTRUCTION_SELECTOR_HPP
+
+#include <climits>
+#include <memory>
+#include "IR.hpp"
+#include "SymbolTable.hpp"
+#include "CodeGenerator.hpp"
+#include "TempAllocator.hpp"
+
+// Wybór rozkazów: tłumaczy IR na kod maszyny wirtualnej. Program główny leży
+// na początku kodu, za nim procedury i procedury biblioteki wykonawczej.
+class InstructionSelector {
+public:
+    InstructionSelector(CodeGenerator& codeGenerator, SymbolTable& symbolTable)
+        : codeGenerator(codeGenerator), symbolTable(symbolTable) {}
+
+    void select(IRProgram& program) {
+        this->program = &program;
+        planRuntimeRoutines();
+        // Komórka 10 (stała 1) jest ustawiana raz, na początku programu głównego
+        symbolTable.one = needsOne();
+
+        for (const auto& function : program.functions) {
+            if (function.isMain) {
+                selectFunction(function);
+            }
+        }
+        for (const auto& function : program.functions) {
+            if (!function.isMain) {
+                codeGenerator.defineRoutine(function.name);
+                selectFunction(function);
+            }
+        }
+        for (const std::string op : {"*", "/", "%"}) {
+            if (!symbolTable.usesRuntimeRoutine(op, false)) {
+                continue;
+            }
+            codeGenerator.defineRoutine(op);
+            if (op == "*") {
+                codeGenerator.emitMultiply(6, 7, symbolTable.one);
+            } else if (op == "/") {
+                codeGenerator.emitDivide(6, 7, symbolTable.one);
+            } else {
+                codeGenerator.emitModulo(6, 7);
+            }
+            codeGenerator.emit("RTRN", symbolTable.runtimeRoutines[op].returnCell);
+        }
+        codeGenerator.resolveLabels();
+    }
+
+private:
+    CodeGenerator& codeGenerator;
+    SymbolTable& symbolTable;
+    IRProgram* program = nullptr;
+
+    // Stan jednej funkcji
+    std::unordered_map<int64_t, int64_t> tempUses;
+    std::unordered_map<int64_t, bool> forwarded;
+    std::vector<int64_t> blockLabels;
+    std::unique_ptr<TempAllocator> allocator;
+    std::vector<int64_t> slotCells;
+
+    static const char* operatorName(IROpcode opcode) {
+        switch (opcode) {
+        case IROpcode::MUL: return "*";
+        case IROpcode::DIV: return "/";
+        case IROpcode::MOD: return "%";
+        default: return "";
+        }
+    }
+
+    // Mnożenie i dzielenie, które wymagają pętli (oba argumenty nieznane)
+    static bool isGenericArithmetic(const IRInstruction& instruction) {
+        if (instruction.opcode == IROpcode::MUL) {
+            return !instruction.left.isConstant() && !instruction.right.isConstant();
+        }
+        if (instruction.opcode == IROpcode::DIV || instruction.opcode == IROpcode::MOD) {
+            return !instruction.right.isConstant() && !(instruction.left.isConstant() && instruction.left.value == 0);
+        }
+        return false;
+    }
+
+    static bool isUnit(const IROperand& operand) {
+        return operand.isConstant() && (operand.value == 1 || operand.value == -1);
+    }
+
+    void planRuntimeRoutines() {
+        for (const auto& function : program->functions) {
+            for (const auto& block : function.blocks) {
+                for (const auto& instruction : block.instructions) {
+                    if (isGenericArithmetic(instruction)) {
+                        symbolTable.addArithmeticSite(operatorName(instruction.opcode), instruction.loopDepth > 0);
+                    }
+                }
+            }
+        }
+        symbolTable.planRuntimeRoutines();
+    }
+
+    bool needsOne() const {
+        if (symbolTable.hasRuntimeRoutines()) {
+            return true;
+        }
+        for (const auto& function : program->functions) {
+            for (const auto& block : function.blocks) {
+                for (const auto& instruction : block.instructions) {
+                    if (isGenericArithmetic(instruction) && instruction.opcode != IROpcode::MOD) {
+                        return true;
+                    }
+                    if ((instruction.opcode == IROpcode::ADD && (isUnit(instruction.left) || isUnit(instruction.right)))
+                        || (instruction.opcode == IROpcode::SUB && isUnit(instruction.right))) {
+                        return true;
+                    }
+                }
+                if (block.terminator == IRTerminator::BRANCH && (isUnit(block.left) || isUnit(block.right))) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    // Argument ładowany jako pierwszy; tylko on może czekać w akumulatorze
+    static IROperand primaryOperand(const IRInstruction& instruction) {
+        switch (instruction.opcode) {
+        case IROpcode::COPY:
+        case IROpcode::LOAD:
+        case IROpcode::STORE:
+        case IROpcode::WRITE:
+        case IROpcode::SUB:
+            return instruction.left;
+        case IROpcode::ADD:
+            if (instruction.left.isTemp()) return instruction.left;
+            if (instruction.right.isTemp()) return instruction.right;
+            return {};
+        default:
+            return {};
+        }
+    }
+
+    static IROperand primaryOperand(const BasicBlock& block) {
+        if (block.terminator == IRTerminator::BRANCH && block.left.isTemp()) {
+            return block.left;
+        }
+        return {};
+    }
+
+    // Zmienne tymczasowe o rozłącznych czasach życia dzielą komórkę
+    int64_t tempCell(int64_t id) {
+        size_t slot = allocator->slotOf(id);
+        while (slotCells.size() <= slot) {
+            slotCells.push_back(symbolTable.allocateCell());
+        }
+        return slotCells[slot];
+    }
+
+    bool isForwarded(const IROperand& operand) const {
+        return operand.isTemp() && forwarded.count(operand.value) && forwarded.at(operand.value);
+    }
+
+    bool inMemory(const IROperand& operand) const {
+        return operand.isCell() || (operand.isTemp() && !isForwarded(operand));
+    }
+
+    int64_t cellOf(const IROperand& operand) {
+        if (operand.isCell()) {
+            return operand.value;
+        }
+        return tempCell(operand.value);
+    }
+
+    // Przekazana zmienna tymczasowa jest zawsze w akumulatorze; o pozostałych
+    // wie śledzenie wartości w generatorze kodu
+    bool inAccumulator(const IROperand& operand) {
+        if (operand.isNone() || operand.isConstant()) {
+            return false;
+        }
+        return isForwarded(operand) || codeGenerator.accumulatorHolds(cellOf(operand));
+    }
+
+    void load(const IROperand& operand) {
+        if (operand.isConstant()) {
+            codeGenerator.emit("SET", operand.value);
+        } else if (!isForwarded(operand)) {
+            codeGenerator.emit("LOAD", cellOf(operand));
+        }
+    }
+
+    void storeResult(const IROperand& result) {
+        if (!isForwarded(result)) {
+            codeGenerator.emit("STORE", cellOf(result));
+        }
+    }
+
+    // Do bloku wchodzi się skokiem albo z więcej niż jednego miejsca
+    static bool isJoin(const std::vector<std::vector<int64_t>>& predecessors, size_t block) {
+        if (block == 0) {
+            return !predecessors[block].empty();
+        }
+        return predecessors[block].size() != 1 || predecessors[block][0] != (int64_t)block - 1;
+    }
+
+    void countUses(const IROperand& operand) {
+        if (operand.isTemp()) {
+            tempUses[operand.value]++;
+        }
+    }
+
+    void selectFunction(const IRFunction& function) {
+        tempUses.clear();
+        forwarded.clear();
+        blockLabels.clear();
+        allocator = std::make_unique<TempAllocator>(*program, function);
+        // Każda procedura ma własne komórki, więc wartości żyjące w czasie
+        // wywołania są bezpieczne. Komórek 8 i 9 nie używa żadna procedura
+        // biblioteczna, a program główny nie jest wywoływany - dostaje je pierwszy
+        slotCells.clear();
+        if (function.isMain) {
+            slotCells = {8, 9};
+        }
+        for (size_t b = 0; b < function.blocks.size(); b++) {
+            blockLabels.push_back(codeGenerator.createLabel());
+        }
+        for (const auto& block : function.blocks) {
+            for (const auto& instruction : block.instructions) {
+                for (const auto& operand : instruction.uses()) {
+                    countUses(operand);
+                }
+            }
+            countUses(block.left);
+            countUses(block.right);
+        }
+
+        if (function.isMain && symbolTable.one) {
+            codeGenerator.emit("SET", 1);
+            codeGenerator.emit("STORE", 10);
+            codeGenerator.pinConstant(10, 1);
+        }
+
+        std::vector<std::vector<int64_t>> predecessors = function.predecessors();
+        for (size_t b = 0; b < function.blocks.size(); b++) {
+            const BasicBlock& block = function.blocks[b];
+            if (isJoin(predecessors, b)) {
+                codeGenerator.markLabel();
+            }
+            codeGenerator.placeLabel(blockLabels[b]);
+            for (size_t i = 0; i < block.instructions.size(); i++) {
+                const IRInstruction& instruction = block.instructions[i];
+                // Zmienna tymczasowa użyta raz, od razu w następnej instrukcji,
+                // zostaje w akumulatorze i nie dostaje komórki
+                if (instruction.definesResult() && instruction.result.isTemp()) {
+                    IROperand next = i + 1 < block.instructions.size() ? primaryOperand(block.instructions[i + 1]) : primaryOperand(block);
+                    forwarded[instruction.result.value] = tempUses[instruction.result.value] == 1 && next == instruction.result;
+                }
+                selectInstruction(instruction);
+            }
+            selectTerminator(function, block, b + 1);
+        }
+    }
+
+    // Akumulator := left - right
+    void emitDifference(const IROperand& left, const IROperand& right) {
+        if (left.isConstant()) {
+            if (left.value == 0) {
+                codeGenerator.emit("SUB", 0);
+            } else {
+                codeGenerator.emit("SET", left.value);
+            }
+            codeGenerator.emit("SUB", cellOf(right));
+            return;
+        }
+        if (!right.isConstant()) {
+            load(left);
+            codeGenerator.emit("SUB", cellOf(right));
+            return;
+        }
+        int64_t constant = right.value;
+        if (constant == 0) {
+            load(left);
+        } else if (isUnit(right) && symbolTable.one) {
+            load(left);
+            codeGenerator.emit(constant == 1 ? "SUB" : "ADD", 10);
+        } else if (constant == INT64_MIN) {
+            if (inAccumulator(left) && !inMemory(left)) {
+                codeGenerator.emit("STORE", 1);
+            } else {
+                codeGenerator.emit("LOAD", cellOf(left));
+                codeGenerator.emit("STORE", 1);
+            }
+            codeGenerator.emit("SET", constant);
+            codeGenerator.emit("STORE", 2);
+            codeGenerator.emit("LOAD", 1);
+            codeGenerator.emit("SUB", 2);
+        } else if (inMemory(left)) {
+            codeGenerator.emit("SET", -constant);
+            codeGenerator.emit("ADD", cellOf(left));
+        } else {
+            codeGenerator.emit("STORE", 1);
+            codeGenerator.emit("SET", -constant);
+            codeGenerator.emit("ADD", 1);
+        }
+    }
+
+    void emitSum(IROperand left, IROperand right) {
+        if (left.isConstant() || (inAccumulator(right) && !inAccumulator(left))) {
+            std::swap(left, right);
+        }
+        if (!right.isConstant()) {
+            load(left);
+            codeGenerator.emit("ADD", cellOf(right));
+            return;
+        }
+        int64_t constant = right.value;
+        if (constant == 0) {
+            load(left);
+        } else if (isUnit(right) && symbolTable.one) {
+            load(left);
+            codeGenerator.emit(constant == 1 ? "ADD" : "SUB", 10);
+        } else if (inMemory(left)) {
+            codeGenerator.emit("SET", constant);
+            codeGenerator.emit("ADD", cellOf(left));
+        } else {
+            codeGenerator.emit("STORE", 1);
+            codeGenerator.emit("SET", constant);
+            codeGenerator.emit("ADD", 1);
+        }
+    }
+
+    // Mnożenie i dzielenie przez zmienną: procedura biblioteczna albo pętla w miejscu
+    void emitGenericArithmetic(const IRInstruction& instruction, int64_t left, int64_t right) {
+        std::string op = operatorName(instruction.opcode);
+        if (symbolTable.usesRuntimeRoutine(op, instruction.loopDepth > 0)) {
+            if (left != 6) {
+                codeGenerator.emit("LOAD", left);
+                codeGenerator.emit("STORE", 6);
+            }
+            if (right != 7) {
+                codeGenerator.emit("LOAD", right);
+                codeGenerator.emit("STORE", 7);
+            }
+            codeGenerator.callRoutine(op, symbolTable.runtimeRoutines[op].returnCell);
+        } else if (instruction.opcode == IROpcode::MUL) {
+            codeGenerator.emitMultiply(left, right, symbolTable.one);
+        } else if (instruction.opcode == IROpcode::DIV) {
+            codeGenerator.emitDivide(left, right, symbolTable.one);
+        } else {
+            codeGenerator.emitModulo(left, right);
+        }
+    }
+
+    void selectMultiplicative(const IRInstruction& instruction) {
+        const IROperand& left = instruction.left;
+        const IROperand& right = instruction.right;
+        if (left.isConstant() && right.isConstant()) {
+            int64_t value;
+            if (instruction.opcode == IROpcode::MUL) {
+                value = (int64_t)((uint64_t)left.value * (uint64_t)right.value);
+            } else if (instruction.opcode == IROpcode::DIV) {
+                value = floorDivide(left.value, right.value);
+            } else {
+                value = floorModulo(left.value, right.value);
+            }
+            codeGenerator.emit("SET", value);
+            return;
+        }
+        if (instruction.opcode == IROpcode::MUL) {
+            if (left.isConstant()) {
+                codeGenerator.emitMultiplyByConstant(cellOf(right), left.value);
+            } else if (right.isConstant()) {
+                codeGenerator.emitMultiplyByConstant(cellOf(left), right.value);
+            } else {
+                emitGenericArithmetic(instruction, cellOf(left), cellOf(right));
+            }
+            return;
+        }
+        if (right.isConstant()) {
+            if (instruction.opcode == IROpcode::DIV) {
+                codeGenerator.emitDivideByConstant(cellOf(left), right.value);
+            } else {
+                codeGenerator.emitModuloByConstant(cellOf(left), right.value);
+            }
+        } else if (left.isConstant()) {
+            if (left.value == 0) {
+                codeGenerator.emit("SUB", 0);
+            } else {
+                codeGenerator.emit("SET", left.value);
+                codeGenerator.emit("STORE", 6);
+                emitGenericArithmetic(instruction, 6, cellOf(right));
+            }
+        } else {
+            emitGenericArithmetic(instruction, cellOf(left), cellOf(right));
+        }
+    }
+
+    void selectInstruction(const IRInstruction& instruction) {
+        switch (instruction.opcode) {
+        case IROpcode::COPY:
+            load(instruction.left);
+            storeResult(instruction.result);
+            break;
+        case IROpcode::ADD:
+            if (instruction.left.isConstant() && instruction.right.isConstant()) {
+                codeGenerator.emit("SET", (int64_t)((uint64_t)instruction.left.value + (uint64_t)instruction.right.value));
+            } else {
+                emitSum(instruction.left, instruction.right);
+            }
+            storeResult(instruction.result);
+            break;
+        case IROpcode::SUB:
+            if (instruction.left.isConstant() && instruction.right.isConstant()) {
+                codeGenerator.emit("SET", (int64_t)((uint64_t)instruction.left.value - (uint64_t)instruction.right.value));
+            } else {
+                emitDifference(instruction.left, instruction.right);
+            }
+            storeResult(instruction.result);
+            break;
+        case IROpcode::MUL:
+        case IROpcode::DIV:
+        case IROpcode::MOD:
+            selectMultiplicative(instruction);
+            storeResult(instruction.result);
+            break;
+        case IROpcode::LOAD:
+            if (inMemory(instruction.left)) {
+                codeGenerator.emit("LOADI", cellOf(instruction.left));
+            } else {
+                load(instruction.left);
+                codeGenerator.emit("LOADI", 0);
+            }
+            storeResult(instruction.result);
+            break;
+        case IROpcode::STORE: {
+            int64_t address = cellOf(instruction.result);
+            load(instruction.left);
+            codeGenerator.emit("STOREI", address);
+            break;
+        }
+        case IROpcode::READ:
+            if (isForwarded(instruction.result)) {
+                codeGenerator.emit("GET", 0);
+            } else {
+                codeGenerator.emit("GET", cellOf(instruction.result));
+            }
+            break;
+        case IROpcode::WRITE:
+            if (instruction.left.isConstant()) {
+                codeGenerator.emit("SET", instruction.left.value);
+                codeGenerator.emit("PUT", 0);
+            } else if (inMemory(instruction.left)) {
+                codeGenerator.emit("PUT", cellOf(instruction.left));
+            } else {
+                codeGenerator.emit("PUT", 0);
+            }
+            break;
+        case IROpcode::CALL: {
+            const IRFunction* callee = program->getFunction(instruction.callee);
+            codeGenerator.callRoutine(callee->name, callee->returnCell);
+            break;
+        }
+        }
+    }
+
+    void selectTerminator(const IRFunction& function, const BasicBlock& block, int64_t next) {
+        switch (block.terminator) {
+        case IRTerminator::JUMP:
+            if (block.target != next) {
+                codeGenerator.emitJump("JUMP", blockLabels[block.target]);
+            }
+            break;
+        case IRTerminator::BRANCH: {
+            emitDifference(block.left, block.right);
+            std::string code;
+            bool onTrue = true;
+            switch (block.condition) {
+            case IRCondition::EQ: code = "JZERO"; onTrue = true; break;
+            case IRCondition::NE: code = "JZERO"; onTrue = false; break;
+            case IRCondition::LT: code = "JNEG"; onTrue = true; break;
+            case IRCondition::GT: code = "JPOS"; onTrue = true; break;
+            case IRCondition::LE: code = "JPOS"; onTrue = false; break;
+            case IRCondition::GE: code = "JNEG"; onTrue = false; break;
+            }
+            int64_t taken = onTrue ? block.target : block.falseTarget;
+            int64_t other = onTrue ? block.falseTarget : block.target;
+            codeGenerator.emitJump(code, blockLabels[taken]);
+            if (other != next) {
+                codeGenerator.emitJump("JUMP", blockLabels[other]);
+            }
+            break;
+        }
+        case IRTerminator::RETURN:
+            codeGenerator.emit("RTRN", function.returnCell);
+            break;
+        case IRTerminator::HALT:
+            codeGenerator.emit("HALT", 0);
+            break;
+        }
+    }
+};
+
+#endif // INSTRUCTION_SELECTOR_HPP
@@ -0,0 +1,92 @@
+#ifndef LIVENESS_HPP
+#define LIVENESS_HPP
+
+#include <set>
+#include <vector>
+#include "IR.hpp"
+
+// Żywotność komórek i zmiennych tymczasowych na granicach bloków (analiza
+// wsteczna). Procedura oddaje wartości parametrów przy powrocie, więc są żywe
+// na RETURN; odczyt spod adresu może czytać każdą komórkę tablicy, a takie
+// komórki (IRProgram::isAddressable) nie są tu śledzone.
+class Liveness {
+public:
+    using Key = std::pair<int, int64_t>;
+
+    Liveness(const IRProgram& program, const IRFunction& function) {
+        size_t count = function.blocks.size();
+        liveIn.assign(count, {});
+        liveOut.assign(count, {});
+        std::vector<std::set<Key>> uses(count), definitions(count);
+        for (const auto& block : function.blocks) {
+            auto use = [&](const IROperand& operand) {
+                if (isTracked(program, operand) && !definitions[block.id].count(key(operand))) {
+                    uses[block.id].insert(key(operand));
+                }
+            };
+            for (const auto& instruction : block.instructions) {
+                for (const auto& operand : instruction.uses()) {
+                    use(operand);
+                }
+                if (instruction.definesResult() && isTracked(program, instruction.result)) {
+                    definitions[block.id].insert(key(instruction.result));
+                }
+            }
+            use(block.left);
+            use(block.right);
+            if (block.terminator == IRTerminator::RETURN) {
+                for (const auto& parameter : function.parameters) {
+                    use(IROperand::cell(parameter.cell));
+                }
+            }
+        }
+
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            for (size_t b = count; b-- > 0;) {
+                std::set<Key> out;
+                for (int64_t successor : function.blocks[b].successors()) {
+                    out.insert(liveIn[successor].begin(), liveIn[successor].end());
+                }
+                std::set<Key> in = uses[b];
+                for (const auto& k : out) {
+                    if (!definitions[b].count(k)) {
+                        in.insert(k);
+                    }
+                }
+                if (in != liveIn[b] || out != liveOut[b]) {
+                    liveIn[b] = in;
+                    liveOut[b] = out;
+                    changed = true;
+                }
+            }
+        }
+    }
+
+    static Key key(const IROperand& operand) {
+        return {(int)operand.kind, operand.value};
+    }
+
+    static bool isTracked(const IRProgram& program, const IROperand& operand) {
+        return operand.isTemp() || (operand.isCell() && !program.isAddressable(operand.value));
+    }
+
+    bool isLiveIn(int64_t block, const IROperand& operand) const {
+        return liveIn[block].count(key(operand)) > 0;
+    }
+
+    bool isLiveOut(int64_t block, const IROperand& operand) const {
+        return liveOut[block].count(key(operand)) > 0;
+    }
+
+    const std::set<Key>& getLiveOut(int64_t block) const {
+        return liveOut[block];
+    }
+
+private:
+    std::vector<std::set<Key>> liveIn;
+    std::vector<std::set<Key>> liveOut;
+};
+
+#endif // LIVENESS_HPP
@@ -0,0 +1,337 @@
+#ifndef LOOP_ANALYSIS_HPP
+#define LOOP_ANALYSIS_HPP
+
+#include <map>
+#include <set>
+#include <tuple>
+#include <vector>
+#include <algorithm>
+#include <unordered_map>
+#include "IR.hpp"
+
+// Drzewo dominatorów (algorytm Coopera, Harveya i Kennedy'ego) i pętle naturalne
+// grafu bloków procedury. Pętla to nagłówek i bloki, z których da się wrócić
+// do nagłówka krawędzią powrotną bez przechodzenia przez niego.
+class LoopAnalysis {
+public:
+    struct Loop {
+        int64_t header;
+        std::set<int64_t> blocks;
+        std::vector<int64_t> latches;   // bloki z krawędzią powrotną do nagłówka
+
+        bool contains(int64_t block) const {
+            return blocks.count(block) > 0;
+        }
+    };
+
+    explicit LoopAnalysis(const IRFunction& function) : function(function) {
+        predecessors = function.predecessors();
+        computeDominators();
+        findLoops();
+    }
+
+    const std::vector<std::vector<int64_t>>& getPredecessors() const {
+        return predecessors;
+    }
+
+    // Pętle od najbardziej wewnętrznych (najmniejszych)
+    const std::vector<Loop>& getLoops() const {
+        return loops;
+    }
+
+    bool dominates(int64_t dominator, int64_t block) const {
+        if (idom[block] == -1) {
+            return false;
+        }
+        while (block != dominator) {
+            if (block == 0) {
+                return false;
+            }
+            block = idom[block];
+        }
+        return true;
+    }
+
+    // Bloki pętli, z których można z niej wyjść
+    std::vector<int64_t> exits(const Loop& loop) const {
+        std::vector<int64_t> result;
+        for (int64_t block : loop.blocks) {
+            for (int64_t successor : function.blocks[block].successors()) {
+                if (!loop.contains(successor)) {
+                    result.push_back(block);
+                    break;
+                }
+            }
+        }
+        return result;
+    }
+
+private:
+    const IRFunction& function;
+    std::vector<std::vector<int64_t>> predecessors;
+    std::vector<int64_t> idom;
+    std::vector<int64_t> postorder;
+    std::vector<Loop> loops;
+
+    void computeDominators() {
+        size_t count = function.blocks.size();
+        postorder.assign(count, -1);
+        std::vector<int64_t> reversePostorder;
+        std::vector<bool> visited(count, false);
+        std::vector<std::pair<int64_t, size_t>> stack = {{0, 0}};
+        visited[0] = true;
+        while (!stack.empty()) {
+            auto& [block, next] = stack.back();
+            std::vector<int64_t> successors = function.blocks[block].successors();
+            if (next < successors.size()) {
+                int64_t successor = successors[next++];
+                if (!visited[successor]) {
+                    visited[successor] = true;
+                    stack.push_back({successor, 0});
+                }
+                continue;
+            }
+            postorder[block] = reversePostorder.size();
+            reversePostorder.push_back(block);
+            stack.pop_back();
+        }
+        std::reverse(reversePostorder.begin(), reversePostorder.end());
+
+        idom.assign(count, -1);
+        idom[0] = 0;
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            for (int64_t block : reversePostorder) {
+                if (block == 0) {
+                    continue;
+                }
+                int64_t dominator = -1;
+                for (int64_t predecessor : predecessors[block]) {
+                    if (idom[predecessor] == -1) {
+                        continue;
+                    }
+                    dominator = dominator == -1 ? predecessor : intersect(predecessor, dominator);
+                }
+                if (dominator != idom[block]) {
+                    idom[block] = dominator;
+                    changed = true;
+                }
+            }
+        }
+    }
+
+    int64_t intersect(int64_t a, int64_t b) const {
+        while (a != b) {
+            while (postorder[a] < postorder[b]) a = idom[a];
+            while (postorder[b] < postorder[a]) b = idom[b];
+        }
+        return a;
+    }
+
+    void findLoops() {
+        std::map<int64_t, Loop> byHeader;
+        for (const auto& block : function.blocks) {
+            for (int64_t successor : block.successors()) {
+                if (!dominates(successor, block.id)) {
+                    continue;
+                }
+                Loop& loop = byHeader[successor];
+                loop.header = successor;
+                loop.blocks.insert(successor);
+                loop.latches.push_back(block.id);
+                std::vector<int64_t> stack = {block.id};
+                while (!stack.empty()) {
+                    int64_t current = stack.back();
+                    stack.pop_back();
+                    if (loop.blocks.insert(current).second) {
+                        stack.insert(stack.end(), predecessors[current].begin(), predecessors[current].end());
+                    }
+                }
+            }
+        }
+        for (auto& [header, loop] : byHeader) {
+            loops.push_back(loop);
+        }
+        std::stable_sort(loops.begin(), loops.end(), [](const Loop& a, const Loop& b) {
+            return a.blocks.size() < b.blocks.size();
+        });
+    }
+};
+
+// Co zmienia się w pętli i które zmienne są w niej indukcyjne, tzn. zmieniają
+// się tylko o niezmienny krok: v := v + step albo v := v - step
+class InductionVariables {
+public:
+    using Key = std::pair<int, int64_t>;
+
+    struct Location {
+        int64_t block;
+        size_t index;
+
+        bool operator<(const Location& other) const {
+            return std::tie(block, index) < std::tie(other.block, other.index);
+        }
+    };
+
+    struct Step {
+        Location location;
+        bool add;
+        IROperand step;
+    };
+
+    InductionVariables(const IRProgram& program, const IRFunction& function, const LoopAnalysis::Loop& loop,
+                       SideEffectAnalysis& sideEffects) : program(program) {
+        for (int64_t b : loop.blocks) {
+            const auto& instructions = function.blocks[b].instructions;
+            for (size_t i = 0; i < instructions.size(); i++) {
+                const IRInstruction& instruction = instructions[i];
+                if (instruction.opcode == IROpcode::STORE) {
+                    indirectStores = true;
+                } else if (instruction.opcode == IROpcode::CALL) {
+                    const SideEffects& callee = sideEffects.of(instruction.callee);
+                    calledCells.insert(callee.cells.begin(), callee.cells.end());
+                    indirectStores = indirectStores || callee.indirectStores;
+                } else if (instruction.definesResult()) {
+                    definitions[key(instruction.result)].push_back(Location{b, i});
+                }
+            }
+        }
+        for (const auto& [variable, locations] : definitions) {
+            std::vector<Step> list;
+            for (const auto& location : locations) {
+                const IRInstruction& instruction = function.blocks[location.block].instructions[location.index];
+                const IROperand& v = instruction.result;
+                if (instruction.opcode == IROpcode::ADD && instruction.left == v && isInvariant(instruction.right)) {
+                    list.push_back(Step{location, true, instruction.right});
+                } else if (instruction.opcode == IROpcode::ADD && instruction.right == v && isInvariant(instruction.left)) {
+                    list.push_back(Step{location, true, instruction.left});
+                } else if (instruction.opcode == IROpcode::SUB && instruction.left == v && isInvariant(instruction.right)) {
+                    list.push_back(Step{location, false, instruction.right});
+                } else {
+                    break;
+                }
+            }
+            IROperand v = function.blocks[locations[0].block].instructions[locations[0].index].result;
+            if (list.size() == locations.size() && !changesOutsideCode(v)) {
+                steps[variable] = list;
+                for (const auto& step : list) {
+                    stepLocations.insert(step.location);
+                }
+            }
+        }
+    }
+
+    static Key key(const IROperand& operand) {
+        return {(int)operand.kind, operand.value};
+    }
+
+    bool isInvariant(const IROperand& operand) const {
+        if (operand.isConstant()) {
+            return true;
+        }
+        return !operand.isNone() && !definitions.count(key(operand)) && !changesOutsideCode(operand);
+    }
+
+    bool isInduction(const IROperand& operand) const {
+        return steps.count(key(operand)) > 0;
+    }
+
+    bool isStep(const Location& location) const {
+        return stepLocations.count(location) > 0;
+    }
+
+    const std::map<Key, std::vector<Step>>& getSteps() const {
+        return steps;
+    }
+
+private:
+    const IRProgram& program;
+    std::map<Key, std::vector<Location>> definitions;
+    std::map<Key, std::vector<Step>> steps;
+    std::set<Location> stepLocations;
+    std::set<int64_t> calledCells;      // komórki zmieniane przez wywołane procedury
+    bool indirectStores = false;
+
+    // Komórka zmieniana poza kodem pętli: przez wywołaną procedurę albo zapis pod adres
+    bool changesOutsideCode(const IROperand& operand) const {
+        return operand.isCell() && (calledCells.count(operand.value)
+            || (indirectStores && program.isAddressable(operand.value)));
+    }
+};
+
+// Bloki przed pętlami, do których przenosi się kod wykonywany raz przed pętlą.
+// Jedyny poprzednik spoza pętli, który skacze prosto do nagłówka, sam jest
+// takim blokiem; w przeciwnym razie powstaje nowy blok z numerem na końcu
+// procedury (numeracja pozostałych się nie zmienia, więc analizę można
+// powtarzać), a layout() ustawia nowe bloki tuż przed nagłówkami.
+class Preheaders {
+public:
+    int64_t get(IRFunction& function, const LoopAnalysis& analysis, const LoopAnalysis::Loop& loop) {
+        auto existing = added.find(loop.header);
+        if (existing != added.end()) {
+            return existing->second;
+        }
+        std::vector<int64_t> outside;
+        for (int64_t predecessor : analysis.getPredecessors()[loop.header]) {
+            if (!loop.contains(predecessor)) {
+                outside.push_back(predecessor);
+            }
+        }
+        if (loop.header != 0 && outside.size() == 1 && function.blocks[outside[0]].terminator == IRTerminator::JUMP) {
+            return outside[0];
+        }
+
+        BasicBlock preheader;
+        preheader.id = function.blocks.size();
+        preheader.terminator = IRTerminator::JUMP;
+        preheader.target = loop.header;
+        preheader.loopDepth = outside.empty() ? 0 : function.blocks[loop.header].loopDepth;
+        for (int64_t predecessor : outside) {
+            BasicBlock& block = function.blocks[predecessor];
+            preheader.loopDepth = std::min(preheader.loopDepth, block.loopDepth);
+            if (block.target == loop.header) block.target = preheader.id;
+            if (block.falseTarget == loop.header) block.falseTarget = preheader.id;
+        }
+        function.blocks.push_back(preheader);
+        added[loop.header] = preheader.id;
+        return preheader.id;
+    }
+
+    void layout(IRFunction& function) {
+        if (added.empty()) {
+            return;
+        }
+        std::set<int64_t> preheaders;
+        for (const auto& [header, preheader] : added) {
+            preheaders.insert(preheader);
+        }
+        std::vector<BasicBlock> blocks;
+        for (const auto& block : function.blocks) {
+            if (preheaders.count(block.id)) {
+                continue;
+            }
+            auto it = added.find(block.id);
+            if (it != added.end()) {
+                blocks.push_back(function.blocks[it->second]);
+            }
+            blocks.push_back(block);
+        }
+        std::unordered_map<int64_t, int64_t> renumber;
+        for (size_t b = 0; b < blocks.size(); b++) {
+            renumber[blocks[b].id] = b;
+        }
+        for (auto& block : blocks) {
+            block.id = renumber[block.id];
+            if (block.target != -1) block.target = renumber[block.target];
+            if (block.falseTarget != -1) block.falseTarget = renumber[block.falseTarget];
+        }
+        function.blocks = blocks;
+        added.clear();
+    }
+
+private:
+    std::map<int64_t, int64_t> added;   // nagłówek -> nowy blok przed nim
+};
+
+#endif // LOOP_ANALYSIS_HPP
@@ -0,0 +1,166 @@
+#ifndef LOOP_COUNTERS_HPP
+#define LOOP_COUNTERS_HPP
+
+#include <map>
+#include <set>
+#include <memory>
+#include "IR.hpp"
+#include "LoopAnalysis.hpp"
+#include "Liveness.hpp"
+
+// Liczniki pętli. Zmienna indukcyjna, którą w pętli czyta tylko warunek
+// wyjścia v OP b (iterator FOR-a nieużywany w ciele, licznik WHILE-a), a po
+// wyjściu jest martwa, zostaje zastąpiona licznikiem c = v - b: warunek
+// c OP 0 to LOAD i skok zamiast LOAD, SUB i skoku w każdym obrocie. Licznik
+// zmienia się o te same kroki co v. Dla warunku b OP v licznikiem jest
+// c = b - v o krokach przeciwnych, a warunek to nadal c OP 0. Iterator
+// czytany w ciele pętli zostaje bez zmian - utrzymywanie obu kosztowałoby
+// więcej, niż oszczędza warunek.
+class LoopCounters {
+public:
+    void run(IRProgram& program) {
+        this->program = &program;
+        sideEffects = std::make_unique<SideEffectAnalysis>(program);
+        for (auto& function : program.functions) {
+            runFunction(function);
+        }
+    }
+
+private:
+    using Key = InductionVariables::Key;
+    using Location = InductionVariables::Location;
+
+    IRProgram* program = nullptr;
+    std::unique_ptr<SideEffectAnalysis> sideEffects;
+
+    void runFunction(IRFunction& function) {
+        std::set<int64_t> done;
+        Preheaders preheaders;
+        while (true) {
+            LoopAnalysis analysis(function);
+            const LoopAnalysis::Loop* next = nullptr;
+            for (const auto& loop : analysis.getLoops()) {
+                if (!done.count(loop.header)) {
+                    next = &loop;
+                    break;
+                }
+            }
+            if (!next) {
+                break;
+            }
+            done.insert(next->header);
+            count(function, analysis, *next, preheaders);
+        }
+        preheaders.layout(function);
+    }
+
+    // Blok z jedynym odczytem v w pętli poza krokami albo -1
+    int64_t findExitTest(const IRFunction& function, const LoopAnalysis::Loop& loop,
+                         const InductionVariables& inductionVariables, const Liveness& liveness, const IROperand& v) {
+        int64_t test = -1;
+        for (int64_t b : loop.blocks) {
+            const BasicBlock& block = function.blocks[b];
+            for (size_t i = 0; i < block.instructions.size(); i++) {
+                if (inductionVariables.isStep(Location{b, i})) {
+                    continue;
+                }
+                for (const auto& operand : block.instructions[i].uses()) {
+                    if (operand == v) {
+                        return -1;
+                    }
+                }
+            }
+            if (block.left == v || block.right == v) {
+                const IROperand& bound = block.left == v ? block.right : block.left;
+                if (test != -1 || bound == v || !inductionVariables.isInvariant(bound)
+                    || (bound.isConstant() && bound.value == 0)) {
+                    return -1;
+                }
+                test = b;
+            }
+            for (int64_t successor : block.successors()) {
+                if (!loop.contains(successor) && liveness.isLiveIn(successor, v)) {
+                    return -1;
+                }
+            }
+        }
+        return test;
+    }
+
+    void count(IRFunction& function, const LoopAnalysis& analysis, const LoopAnalysis::Loop& loop, Preheaders& preheaders) {
+        InductionVariables inductionVariables(*program, function, loop, *sideEffects);
+        Liveness liveness(*program, function);
+        std::map<Key, int64_t> tests;
+        for (const auto& [variable, steps] : inductionVariables.getSteps()) {
+            IROperand v{(IROperand::Kind)variable.first, variable.second};
+            if (!Liveness::isTracked(*program, v)) {
+                continue;
+            }
+            int64_t test = findExitTest(function, loop, inductionVariables, liveness, v);
+            if (test != -1) {
+                tests[variable] = test;
+            }
+        }
+        if (tests.empty()) {
+            return;
+        }
+
+        int64_t target = preheaders.get(function, analysis, loop);
+        for (const auto& [variable, test] : tests) {
+            IROperand v{(IROperand::Kind)variable.first, variable.second};
+            IROperand counter = IROperand::temp(program->tempCount++);
+            BasicBlock& block = function.blocks[test];
+            bool left = block.left == v;
+            IROperand bound = left ? block.right : block.left;
+            // v OP b <=> v - b OP 0 oraz b OP v <=> b - v OP 0, więc licznik
+            // zawsze stoi po lewej stronie
+            block.left = counter;
+            block.right = IROperand::constant(0);
+
+            for (const auto& step : inductionVariables.getSteps().at(variable)) {
+                bool add = step.add == left;
+                function.blocks[step.location.block].instructions[step.location.index] = IRInstruction{
+                    add ? IROpcode::ADD : IROpcode::SUB, counter, counter, step.step, -1,
+                    function.blocks[step.location.block].loopDepth};
+            }
+
+            BasicBlock& preheader = function.blocks[target];
+            IROperand start = initialValue(preheader, v);
+            preheader.instructions.push_back(IRInstruction{IROpcode::SUB, counter,
+                left ? start : bound, left ? bound : start, -1, preheader.loopDepth});
+        }
+    }
+
+    // Wartość v na końcu bloku przed pętlą: źródło ostatniej kopii v := x,
+    // o ile x się potem nie zmienia. Kopia, której nikt już nie czyta, znika.
+    static IROperand initialValue(BasicBlock& preheader, const IROperand& v) {
+        auto& instructions = preheader.instructions;
+        for (size_t i = instructions.size(); i-- > 0;) {
+            const IRInstruction& instruction = instructions[i];
+            if (!instruction.definesResult() || !(instruction.result == v)) {
+                continue;
+            }
+            if (instruction.opcode != IROpcode::COPY) {
+                return v;
+            }
+            IROperand source = instruction.left;
+            bool read = false;
+            for (size_t j = i + 1; j < instructions.size(); j++) {
+                if (instructions[j].opcode == IROpcode::STORE || instructions[j].opcode == IROpcode::CALL
+                    || (instructions[j].definesResult() && instructions[j].result == source)) {
+                    return v;
+                }
+                for (const auto& operand : instructions[j].uses()) {
+                    read = read || operand == v;
+                }
+            }
+            if (!read) {
+                instructions.erase(instructions.begin() + i);
+            }
+            return source;
+        }
+        return v;
+    }
+};
+
+#endif // LOOP_COUNTERS_HPP
@@ -0,0 +1,201 @@
+#ifndef LOOP_INVARIANT_CODE_MOTION_HPP
+#define LOOP_INVARIANT_CODE_MOTION_HPP
+
+#include <map>
+#include <set>
+#include <memory>
+#include "IR.hpp"
+#include "LoopAnalysis.hpp"
+
+// Wyciąganie niezmienników z pętli (WHILE, REPEAT, FOR) do bloku przed pętlą.
+// Obliczenie, którego argumenty nie zmieniają się w pętli, wykonuje się raz
+// przed nią. Wynik do zmiennej tymczasowej przenosimy w całości; gdy wynikiem
+// jest komórka, w pętli zostaje tylko kopia (pętla może nie wykonać się ani
+// razu, a komórka nie może wtedy zmienić wartości). Dzielenie przez 0 daje 0,
+// więc wykonanie obliczenia "na zapas" jest bezpieczne. Odczyt spod adresu
+// wyciągamy tylko z bloku, przez który przechodzi każde wyjście z pętli.
+// Stałe inne niż 0 i ±1 w pętli (SET kosztuje 50) trafiają przed pętlę
+// do zmiennej tymczasowej - w pętli zostaje LOAD/ADD/SUB komórki (10).
+class LoopInvariantCodeMotion {
+public:
+    void run(IRProgram& program) {
+        this->program = &program;
+        sideEffects = std::make_unique<SideEffectAnalysis>(program);
+        for (auto& function : program.functions) {
+            runFunction(function);
+        }
+    }
+
+private:
+    // Co zmienia się w pętli
+    struct Definitions {
+        std::set<int64_t> cells;
+        std::map<int64_t, int64_t> temps;   // zmienna tymczasowa -> liczba definicji
+        bool indirectStores = false;
+        bool memoryWrites = false;          // zapis do komórki dostępnej przez adres
+    };
+
+    IRProgram* program = nullptr;
+    std::unique_ptr<SideEffectAnalysis> sideEffects;
+
+    void runFunction(IRFunction& function) {
+        std::set<int64_t> done;
+        Preheaders preheaders;
+        while (true) {
+            LoopAnalysis analysis(function);
+            const LoopAnalysis::Loop* next = nullptr;
+            for (const auto& loop : analysis.getLoops()) {
+                if (!done.count(loop.header)) {
+                    next = &loop;
+                    break;
+                }
+            }
+            if (!next) {
+                break;
+            }
+            done.insert(next->header);
+            hoist(function, analysis, *next, preheaders);
+        }
+        preheaders.layout(function);
+    }
+
+    Definitions definitionsIn(const IRFunction& function, const LoopAnalysis::Loop& loop) {
+        Definitions definitions;
+        for (int64_t b : loop.blocks) {
+            for (const auto& instruction : function.blocks[b].instructions) {
+                if (instruction.opcode == IROpcode::STORE) {
+                    definitions.indirectStores = true;
+                } else if (instruction.opcode == IROpcode::CALL) {
+                    const SideEffects& callee = sideEffects->of(instruction.callee);
+                    definitions.cells.insert(callee.cells.begin(), callee.cells.end());
+                    definitions.indirectStores = definitions.indirectStores || callee.indirectStores;
+                } else if (instruction.definesResult()) {
+                    if (instruction.result.isCell()) {
+                        definitions.cells.insert(instruction.result.value);
+                    } else {
+                        definitions.temps[instruction.result.value]++;
+                    }
+                }
+            }
+        }
+        definitions.memoryWrites = definitions.indirectStores;
+        for (int64_t cell : definitions.cells) {
+            definitions.memoryWrites = definitions.memoryWrites || program->isAddressable(cell);
+        }
+        return definitions;
+    }
+
+    bool isInvariant(const IROperand& operand, const Definitions& definitions) const {
+        if (operand.isCell()) {
+            return !definitions.cells.count(operand.value)
+                && !(definitions.indirectStores && program->isAddressable(operand.value));
+        }
+        if (operand.isTemp()) {
+            return !definitions.temps.count(operand.value);
+        }
+        return true;
+    }
+
+    static bool isCheapConstant(const IROperand& operand) {
+        return operand.value == 0 || operand.value == 1 || operand.value == -1;
+    }
+
+    void hoist(IRFunction& function, const LoopAnalysis& analysis, const LoopAnalysis::Loop& loop,
+               Preheaders& preheaders) {
+        Definitions definitions = definitionsIn(function, loop);
+        std::vector<int64_t> exits = analysis.exits(loop);
+        std::vector<IRInstruction> hoisted;
+
+        // Bloki w kolejności rozmieszczenia: niezmiennik, od którego zależy
+        // następny, jest już wyciągnięty
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            for (int64_t b : loop.blocks) {
+                bool dominatesExits = true;
+                for (int64_t exit : exits) {
+                    dominatesExits = dominatesExits && analysis.dominates(b, exit);
+                }
+                auto& instructions = function.blocks[b].instructions;
+                for (auto it = instructions.begin(); it != instructions.end();) {
+                    IRInstruction& instruction = *it;
+                    bool candidate = instruction.isArithmetic()
+                        || (instruction.opcode == IROpcode::COPY && instruction.result.isTemp())
+                        || (instruction.opcode == IROpcode::LOAD && dominatesExits);
+                    if (!candidate || !isInvariant(instruction.left, definitions) || !isInvariant(instruction.right, definitions)) {
+                        ++it;
+                        continue;
+                    }
+                    if (instruction.opcode == IROpcode::LOAD && definitions.memoryWrites) {
+                        ++it;
+                        continue;
+                    }
+                    if (instruction.result.isTemp() && definitions.temps[instruction.result.value] == 1) {
+                        definitions.temps.erase(instruction.result.value);
+                        hoisted.push_back(instruction);
+                        it = instructions.erase(it);
+                        changed = true;
+                        continue;
+                    }
+                    if (instruction.result.isCell() && instruction.opcode != IROpcode::COPY) {
+                        IROperand value = IROperand::temp(program->tempCount++);
+                        IRInstruction computation = instruction;
+                        computation.result = value;
+                        hoisted.push_back(computation);
+                        instruction = IRInstruction{IROpcode::COPY, instruction.result, value, {}, -1, instruction.loopDepth};
+                        changed = true;
+                    }
+                    ++it;
+                }
+            }
+        }
+
+        std::map<int64_t, IROperand> constants;
+        auto materialize = [&](IROperand& operand) {
+            if (!operand.isConstant() || isCheapConstant(operand)) {
+                return;
+            }
+            auto it = constants.find(operand.value);
+            if (it == constants.end()) {
+                IROperand value = IROperand::temp(program->tempCount++);
+                hoisted.push_back(IRInstruction{IROpcode::COPY, value, operand, {}, -1});
+                it = constants.emplace(operand.value, value).first;
+            }
+            operand = it->second;
+        };
+        for (int64_t b : loop.blocks) {
+            BasicBlock& block = function.blocks[b];
+            for (auto& instruction : block.instructions) {
+                switch (instruction.opcode) {
+                case IROpcode::ADD:
+                case IROpcode::SUB:
+                    materialize(instruction.left);
+                    materialize(instruction.right);
+                    break;
+                case IROpcode::COPY:
+                case IROpcode::STORE:
+                case IROpcode::WRITE:
+                    materialize(instruction.left);
+                    break;
+                default:
+                    break;
+                }
+            }
+            if (block.terminator == IRTerminator::BRANCH) {
+                materialize(block.left);
+                materialize(block.right);
+            }
+        }
+
+        if (!hoisted.empty()) {
+            int64_t target = preheaders.get(function, analysis, loop);
+            BasicBlock& preheader = function.blocks[target];
+            for (auto& instruction : hoisted) {
+                instruction.loopDepth = preheader.loopDepth;
+            }
+            preheader.instructions.insert(preheader.instructions.end(), hoisted.begin(), hoisted.end());
+        }
+    }
+};
+
+#endif // LOOP_INVARIANT_CODE_MOTION_HPP
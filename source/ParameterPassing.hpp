@@ -0,0 +1,116 @@
+#ifndef PARAMETER_PASSING_HPP
+#define PARAMETER_PASSING_HPP
+
+#include <set>
+#include <unordered_map>
+#include "IR.hpp"
+
+// Przekazywanie parametrów skalarnych przez wartość-wynik bez zbędnych kopii.
+// Kopia do procedury jest pomijana, gdy procedura nie czyta parametru przed zapisem,
+// kopia z powrotem - gdy go nie zapisuje.
+// Przekazanie przez adres się nie opłaca: SET adresu i STORE do parametru
+// kosztują 60 na wywołanie, a każdy dostęp w treści (LOADI/STOREI) o 10 więcej,
+// podczas gdy obie kopie wartość-wynik kosztują razem najwyżej 40.
+// Ramki procedur, które nie są aktywne jednocześnie, nakładają się, więc ta sama
+// komórka może być parametrem kilku procedur - dostępy są liczone osobno
+// dla każdej procedury.
+class ParameterPassing {
+public:
+    void run(IRProgram& program) {
+        this->program = &program;
+        collectUsage();
+        for (auto& function : program.functions) {
+            rewrite(function);
+        }
+    }
+
+private:
+    struct Usage {
+        int64_t reads = 0;
+        int64_t writes = 0;
+        bool writtenInEntry = false;
+
+        bool needsCopyIn() const {
+            return reads > 0 || (writes > 0 && !writtenInEntry);
+        }
+
+        bool needsCopyOut() const {
+            return writes > 0;
+        }
+    };
+
+    IRProgram* program = nullptr;
+    std::unordered_map<int64_t, std::unordered_map<int64_t, Usage>> usage;     // procedura -> parametr -> dostępy
+
+    void collectUsage() {
+        usage.clear();
+        for (const auto& function : program->functions) {
+            // Kopie do parametrów wywoływanych procedur nie są dostępami do własnych parametrów
+            std::set<int64_t> scalars;
+            auto& usage = this->usage[function.id];
+            for (const auto& parameter : function.parameters) {
+                if (!parameter.isArray) {
+                    usage[parameter.cell] = Usage();
+                    scalars.insert(parameter.cell);
+                }
+            }
+            auto isScalar = [&](const IROperand& operand) {
+                return operand.isCell() && scalars.count(operand.value) > 0;
+            };
+            for (const auto& block : function.blocks) {
+                for (const auto& instruction : block.instructions) {
+                    for (const auto& operand : instruction.uses()) {
+                        if (isScalar(operand)) {
+                            usage[operand.value].reads++;
+                        }
+                    }
+                    if (instruction.definesResult() && isScalar(instruction.result)) {
+                        Usage& parameterUsage = usage[instruction.result.value];
+                        parameterUsage.writes++;
+                        if (block.id == 0 && parameterUsage.reads == 0) {
+                            parameterUsage.writtenInEntry = true;
+                        }
+                    }
+                }
+                for (const auto& operand : {block.left, block.right}) {
+                    if (isScalar(operand)) {
+                        usage[operand.value].reads++;
+                    }
+                }
+            }
+        }
+    }
+
+    void rewrite(IRFunction& function) {
+        for (auto& block : function.blocks) {
+            // Kopie parametrów przy wywołaniach: wiersz -> procedura wywoływana
+            std::unordered_map<size_t, int64_t> copyIns;
+            std::unordered_map<size_t, int64_t> copyOuts;
+            for (size_t i = 0; i < block.instructions.size(); i++) {
+                if (block.instructions[i].opcode == IROpcode::CALL) {
+                    int64_t callee = block.instructions[i].callee;
+                    CallCopies copies = findCallCopies(block, i, *program->getFunction(callee));
+                    for (size_t c = copies.copyIn; c < i; c++) copyIns[c] = callee;
+                    for (size_t c = i + 1; c < copies.copyOut; c++) copyOuts[c] = callee;
+                }
+            }
+
+            std::vector<IRInstruction> code;
+            for (size_t i = 0; i < block.instructions.size(); i++) {
+                const IRInstruction& instruction = block.instructions[i];
+                if (copyIns.count(i) && usage[copyIns[i]].count(instruction.result.value)
+                    && !usage[copyIns[i]][instruction.result.value].needsCopyIn()) {
+                    continue;
+                }
+                if (copyOuts.count(i) && usage[copyOuts[i]].count(instruction.left.value)
+                    && !usage[copyOuts[i]][instruction.left.value].needsCopyOut()) {
+                    continue;
+                }
+                code.push_back(instruction);
+            }
+            block.instructions = code;
+        }
+    }
+};
+
+#endif // PARAMETER_PASSING_HPP
@@ -0,0 +1,245 @@
+#ifndef PEEPHOLE_OPTIMIZER_HPP
+#define PEEPHOLE_OPTIMIZER_HPP
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <functional>
+#include <unordered_set>
+#include "CodeGenerator.hpp"
+
+// Optymalizacja przez szparkę na gotowym kodzie maszyny wirtualnej. Skoki są
+// zamieniane na bezwzględne numery wierszy, wzorce z tabeli usuwają lub
+// przepisują rozkazy, a na końcu przesunięcia skoków są liczone od nowa.
+class PeepholeOptimizer {
+public:
+    PeepholeOptimizer(CodeGenerator& codeGenerator) : codeGenerator(codeGenerator) {
+        patterns = {
+            {"jump to next line", [this](size_t i) { return removeJumpToNext(i); }},
+            {"jump to jump", [this](size_t i) { return threadJump(i); }},
+            {"STORE x; LOAD x", [this](size_t i) { return removeLoadAfterStore(i); }},
+            {"LOAD x; STORE x", [this](size_t i) { return removeStoreAfterLoad(i); }},
+            {"STORE x; STORE x", [this](size_t i) { return removeOverwrittenStore(i); }},
+            {"overwritten accumulator", [this](size_t i) { return removeOverwrittenAccumulator(i); }},
+            {"unreachable code", [this](size_t i) { return removeUnreachable(i); }},
+        };
+    }
+
+    void run() {
+        load();
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            findLeaders();
+            for (size_t i = 0; i < code.size(); i++) {
+                for (const auto& pattern : patterns) {
+                    if (pattern.apply(i)) {
+                        changed = true;
+                        break;
+                    }
+                }
+            }
+            compact();
+        }
+        save();
+    }
+
+private:
+    struct Instruction {
+        command cmd;
+        int64_t target = -1;    // bezwzględny wiersz celu skoku albo adresu powrotu
+        bool isAddress = false; // SET z adresem powrotu
+        bool removed = false;
+    };
+
+    struct Pattern {
+        std::string name;
+        std::function<bool(size_t)> apply;
+    };
+
+    CodeGenerator& codeGenerator;
+    std::vector<Pattern> patterns;
+    std::vector<Instruction> code;
+    std::unordered_set<int64_t> leaders;
+
+    static bool isJump(const std::string& code) {
+        return code == "JUMP" || code == "JPOS" || code == "JZERO" || code == "JNEG";
+    }
+
+    // Rozkazy, które tylko czytają pamięć i zmieniają akumulator
+    static bool writesOnlyAccumulator(const command& cmd) {
+        return cmd.code == "LOAD" || cmd.code == "SET" || cmd.code == "ADD" || cmd.code == "SUB"
+            || cmd.code == "HALF" || cmd.code == "LOADI" || cmd.code == "ADDI" || cmd.code == "SUBI";
+    }
+
+    // Rozkazy, które nadpisują akumulator bez czytania jego poprzedniej wartości.
+    // GET i zapisuje tylko komórkę i, więc akumulator nadpisuje jedynie GET 0.
+    static bool overwritesAccumulator(const command& cmd) {
+        if (cmd.code == "SET") {
+            return true;
+        }
+        if (cmd.code == "LOAD" || cmd.code == "LOADI") {
+            return cmd.arg != 0;
+        }
+        if (cmd.code == "GET") {
+            return cmd.arg == 0;
+        }
+        return false;
+    }
+
+    void load() {
+        std::vector<command> generated = codeGenerator.getGeneratedCode();
+        code.clear();
+        for (size_t i = 0; i < generated.size(); i++) {
+            Instruction instruction;
+            instruction.cmd = generated[i];
+            if (isJump(generated[i].code)) {
+                instruction.target = i + generated[i].arg;
+            }
+            code.push_back(instruction);
+        }
+        for (auto line : codeGenerator.getAddressLines()) {
+            code[line].isAddress = true;
+            code[line].target = code[line].cmd.arg;
+        }
+    }
+
+    void save() {
+        std::vector<command> generated;
+        std::vector<u_int64_t> addressLines;
+        for (size_t i = 0; i < code.size(); i++) {
+            command cmd = code[i].cmd;
+            if (isJump(cmd.code)) {
+                cmd.arg = code[i].target - i;
+            } else if (code[i].isAddress) {
+                cmd.arg = code[i].target;
+                addressLines.push_back(i);
+            }
+            generated.push_back(cmd);
+        }
+        codeGenerator.setGeneratedCode(generated, addressLines);
+    }
+
+    // Wiersze, do których można wejść inaczej niż z poprzedniego wiersza
+    void findLeaders() {
+        leaders.clear();
+        leaders.insert(0);
+        for (const auto& instruction : code) {
+            if (instruction.target != -1) {
+                leaders.insert(instruction.target);
+            }
+        }
+    }
+
+    bool isLeader(size_t i) const {
+        return leaders.count(i) > 0;
+    }
+
+    // Usuwa oznaczone rozkazy; cel usuniętego rozkazu przechodzi na następny zachowany
+    void compact() {
+        std::vector<int64_t> newIndex(code.size() + 1);
+        int64_t next = 0;
+        for (size_t i = 0; i < code.size(); i++) {
+            newIndex[i] = next;
+            if (!code[i].removed) {
+                next++;
+            }
+        }
+        newIndex[code.size()] = next;
+        std::vector<Instruction> result;
+        for (auto instruction : code) {
+            if (instruction.removed) {
+                continue;
+            }
+            if (instruction.target != -1) {
+                instruction.target = newIndex[instruction.target];
+            }
+            result.push_back(instruction);
+        }
+        code = result;
+    }
+
+    // Następny rozkaz w tym samym przebiegu; wzorce nie zachodzą na siebie
+    bool hasNext(size_t i) const {
+        return i + 1 < code.size() && !code[i].removed && !code[i + 1].removed;
+    }
+
+    bool removeJumpToNext(size_t i) {
+        if (!code[i].removed && isJump(code[i].cmd.code) && code[i].target == (int64_t)i + 1) {
+            code[i].removed = true;
+            return true;
+        }
+        return false;
+    }
+
+    bool threadJump(size_t i) {
+        if (code[i].removed || !isJump(code[i].cmd.code)) {
+            return false;
+        }
+        int64_t target = code[i].target;
+        int64_t steps = 0;
+        while (target < (int64_t)code.size() && code[target].cmd.code == "JUMP"
+               && code[target].target != target && steps < (int64_t)code.size()) {
+            target = code[target].target;
+            steps++;
+        }
+        if (target < (int64_t)code.size() && code[i].cmd.code == "JUMP"
+            && (code[target].cmd.code == "HALT" || code[target].cmd.code == "RTRN")) {
+            code[i].cmd = code[target].cmd;
+            code[i].target = -1;
+            return true;
+        }
+        if (target != code[i].target) {
+            code[i].target = target;
+            return true;
+        }
+        return false;
+    }
+
+    bool removeLoadAfterStore(size_t i) {
+        if (hasNext(i) && !isLeader(i + 1) && code[i].cmd.code == "STORE"
+            && code[i + 1].cmd.code == "LOAD" && code[i].cmd.arg == code[i + 1].cmd.arg) {
+            code[i + 1].removed = true;
+            return true;
+        }
+        return false;
+    }
+
+    bool removeStoreAfterLoad(size_t i) {
+        if (hasNext(i) && !isLeader(i + 1) && code[i].cmd.code == "LOAD"
+            && code[i + 1].cmd.code == "STORE" && code[i].cmd.arg == code[i + 1].cmd.arg) {
+            code[i + 1].removed = true;
+            return true;
+        }
+        return false;
+    }
+
+    bool removeOverwrittenStore(size_t i) {
+        if (hasNext(i) && !isLeader(i + 1) && code[i].cmd.code == "STORE"
+            && code[i + 1].cmd.code == "STORE" && code[i].cmd.arg == code[i + 1].cmd.arg) {
+            code[i].removed = true;
+            return true;
+        }
+        return false;
+    }
+
+    bool removeOverwrittenAccumulator(size_t i) {
+        if (hasNext(i) && !isLeader(i + 1) && !code[i].isAddress
+            && writesOnlyAccumulator(code[i].cmd) && overwritesAccumulator(code[i + 1].cmd)) {
+            code[i].removed = true;
+            return true;
+        }
+        return false;
+    }
+
+    bool removeUnreachable(size_t i) {
+        const std::string& op = code[i].cmd.code;
+        if (hasNext(i) && !isLeader(i + 1) && (op == "JUMP" || op == "HALT" || op == "RTRN")) {
+            code[i + 1].removed = true;
+            return true;
+        }
+        return false;
+    }
+};
+
+#endif // PEEPHOLE_OPTIMIZER_HPP
@@ -0,0 +1,335 @@
+#ifndef STRENGTH_REDUCTION_HPP
+#define STRENGTH_REDUCTION_HPP
+
+#include <map>
+#include <set>
+#include <tuple>
+#include <memory>
+#include "IR.hpp"
+#include "LoopAnalysis.hpp"
+#include "Liveness.hpp"
+
+// Redukcja mocy dla zmiennych indukcyjnych. Zmienna indukcyjna zmienia się
+// w pętli tylko o niezmienny krok (iterator FOR-a, licznik WHILE-a). Wyrażenia
+// v * k, v + k, v - k i k - v z niezmiennym k (adres tab[i] to baza + i)
+// liczone są raz przed pętlą do zmiennej tymczasowej r, którą każda zmiana v
+// przesuwa o krok: jedno ADD/SUB zamiast mnożenia albo sumy w każdym obrocie.
+// Gdy zmienną czyta poza tym tylko warunek wyjścia, warunek przechodzi na sumę,
+// a samej zmiennej nie trzeba już liczyć.
+class StrengthReduction {
+public:
+    void run(IRProgram& program) {
+        this->program = &program;
+        sideEffects = std::make_unique<SideEffectAnalysis>(program);
+        for (auto& function : program.functions) {
+            runFunction(function);
+        }
+    }
+
+private:
+    using Key = InductionVariables::Key;
+    using Location = InductionVariables::Location;
+
+    // Wyrażenie v * k, v + k, v - k albo k - v (reversed)
+    struct Derived {
+        IROpcode opcode;
+        Key variable;
+        IROperand invariant;
+        bool reversed;
+
+        bool operator<(const Derived& other) const {
+            return std::tie(opcode, variable, invariant.kind, invariant.value, reversed)
+                 < std::tie(other.opcode, other.variable, other.invariant.kind, other.invariant.value, other.reversed);
+        }
+    };
+
+    IRProgram* program = nullptr;
+    std::unique_ptr<SideEffectAnalysis> sideEffects;
+
+    static Key key(const IROperand& operand) {
+        return InductionVariables::key(operand);
+    }
+
+    void runFunction(IRFunction& function) {
+        std::set<int64_t> done;
+        Preheaders preheaders;
+        while (true) {
+            LoopAnalysis analysis(function);
+            const LoopAnalysis::Loop* next = nullptr;
+            for (const auto& loop : analysis.getLoops()) {
+                if (!done.count(loop.header)) {
+                    next = &loop;
+                    break;
+                }
+            }
+            if (!next) {
+                break;
+            }
+            done.insert(next->header);
+            reduce(function, analysis, *next, preheaders);
+        }
+        preheaders.layout(function);
+    }
+
+    static bool isMultiplier(const IROperand& operand, int64_t limit) {
+        return !operand.isConstant() || operand.value > limit || operand.value < -limit;
+    }
+
+    // Mnożenie przez zmienną albo dużą stałą jest droższe niż ADD/SUB w każdym
+    // obrocie; suma (np. adres tab[i]) opłaca się dopiero, gdy się powtarza
+    static bool profitable(const Derived& derived, size_t count) {
+        if (derived.opcode == IROpcode::MUL) {
+            if (!isMultiplier(derived.invariant, 1)) {
+                return false;
+            }
+            return count > 1 || isMultiplier(derived.invariant, 4);
+        }
+        return count > 1;
+    }
+
+    void reduce(IRFunction& function, const LoopAnalysis& analysis, const LoopAnalysis::Loop& loop, Preheaders& preheaders) {
+        InductionVariables inductionVariables(*program, function, loop, *sideEffects);
+        if (inductionVariables.getSteps().empty()) {
+            return;
+        }
+
+        std::map<Derived, std::vector<Location>> groups;
+        for (int64_t b : loop.blocks) {
+            const auto& instructions = function.blocks[b].instructions;
+            for (size_t i = 0; i < instructions.size(); i++) {
+                const IRInstruction& instruction = instructions[i];
+                if (inductionVariables.isStep(Location{b, i})) {
+                    continue;
+                }
+                bool commutative = instruction.opcode == IROpcode::ADD || instruction.opcode == IROpcode::MUL;
+                if (!commutative && instruction.opcode != IROpcode::SUB) {
+                    continue;
+                }
+                if (inductionVariables.isInduction(instruction.left) && inductionVariables.isInvariant(instruction.right)) {
+                    groups[Derived{instruction.opcode, key(instruction.left), instruction.right, false}].push_back(Location{b, i});
+                } else if (inductionVariables.isInduction(instruction.right) && inductionVariables.isInvariant(instruction.left)) {
+                    groups[Derived{instruction.opcode, key(instruction.right), instruction.left, !commutative}].push_back(Location{b, i});
+                }
+            }
+        }
+
+        // Zmienna indukcyjna czytana poza krokami tylko przez warunek wyjścia
+        // i sumy v + k albo v - k przestaje być liczona: warunek przechodzi
+        // na jedną z sum (v <= b to v + k <= b + k), która niesie pętlę
+        std::map<Key, int64_t> exitTests = findExitTests(function, loop, inductionVariables);
+        std::map<Key, Derived> carriers;
+        for (const auto& [derived, locations] : groups) {
+            bool sum = derived.opcode == IROpcode::ADD || (derived.opcode == IROpcode::SUB && !derived.reversed);
+            if (sum && exitTests.count(derived.variable) && !carriers.count(derived.variable)) {
+                carriers.emplace(derived.variable, derived);
+            }
+        }
+        // Poza sumą niosącą pętlę każda suma musi się opłacać i bez tego
+        for (const auto& [derived, locations] : groups) {
+            auto carrier = carriers.find(derived.variable);
+            if (carrier != carriers.end() && (derived < carrier->second || carrier->second < derived)
+                && !profitable(derived, locations.size())) {
+                carriers.erase(carrier);
+            }
+        }
+
+        std::vector<IRInstruction> initialization;
+        std::map<std::pair<int64_t, size_t>, std::vector<IRInstruction>> updates;
+        std::map<std::pair<int64_t, size_t>, IROperand> replacements;
+        std::set<Location> removedSteps;
+        for (const auto& [derived, locations] : groups) {
+            auto carrier = carriers.find(derived.variable);
+            bool removed = carrier != carriers.end();
+            bool carries = removed && !(derived < carrier->second) && !(carrier->second < derived);
+            if (!removed && !profitable(derived, locations.size())) {
+                continue;
+            }
+            IROperand running = IROperand::temp(program->tempCount++);
+            const IRInstruction& first = function.blocks[locations[0].block].instructions[locations[0].index];
+            IRInstruction start = first;
+            start.result = running;
+            initialization.push_back(start);
+            if (carries) {
+                BasicBlock& test = function.blocks[exitTests[derived.variable]];
+                IROperand& variable = key(test.left) == derived.variable ? test.left : test.right;
+                IROperand& bound = key(test.left) == derived.variable ? test.right : test.left;
+                bound = shiftedBound(bound, derived, initialization);
+                variable = running;
+                for (const auto& step : inductionVariables.getSteps().at(derived.variable)) {
+                    removedSteps.insert(step.location);
+                }
+            }
+            for (const auto& step : inductionVariables.getSteps().at(derived.variable)) {
+                bool add = step.add != derived.reversed;
+                IROperand amount = step.step;
+                if (derived.opcode == IROpcode::MUL) {
+                    amount = scaledStep(step.step, derived.invariant, initialization);
+                }
+                const IRInstruction& change = function.blocks[step.location.block].instructions[step.location.index];
+                updates[{step.location.block, step.location.index}].push_back(
+                    IRInstruction{add ? IROpcode::ADD : IROpcode::SUB, running, running, amount, -1, change.loopDepth});
+            }
+            for (const auto& location : locations) {
+                replacements[{location.block, location.index}] = running;
+            }
+        }
+        if (initialization.empty()) {
+            return;
+        }
+
+        // Sumy zamiast wyrażeń, a zaraz po każdej zmianie zmiennej indukcyjnej przesunięcie sum
+        for (int64_t b : loop.blocks) {
+            BasicBlock& block = function.blocks[b];
+            std::vector<IRInstruction> code;
+            for (size_t i = 0; i < block.instructions.size(); i++) {
+                const IRInstruction& instruction = block.instructions[i];
+                auto replacement = replacements.find({b, i});
+                if (removedSteps.count(Location{b, i})) {
+                    // zmiana zmiennej, której nikt już nie czyta
+                } else if (replacement == replacements.end()) {
+                    code.push_back(instruction);
+                } else if (!renameUses(function, b, i, replacement->second, inductionVariables)) {
+                    code.push_back(IRInstruction{IROpcode::COPY, instruction.result, replacement->second, {}, -1, instruction.loopDepth});
+                }
+                auto update = updates.find({b, i});
+                if (update != updates.end()) {
+                    code.insert(code.end(), update->second.begin(), update->second.end());
+                }
+            }
+            block.instructions = code;
+        }
+
+        int64_t target = preheaders.get(function, analysis, loop);
+        BasicBlock& preheader = function.blocks[target];
+        for (auto& instruction : initialization) {
+            instruction.loopDepth = preheader.loopDepth;
+        }
+        preheader.instructions.insert(preheader.instructions.end(), initialization.begin(), initialization.end());
+    }
+
+    // Jedyny warunek wyjścia porównujący v z niezmiennikiem, o ile pętla poza
+    // krokami i sumami v + k, v - k nie czyta v, a po wyjściu v jest martwa
+    std::map<Key, int64_t> findExitTests(const IRFunction& function, const LoopAnalysis::Loop& loop,
+                                         const InductionVariables& inductionVariables) {
+        std::map<Key, int64_t> result;
+        Liveness liveness(*program, function);
+        for (const auto& [variable, steps] : inductionVariables.getSteps()) {
+            IROperand v{(IROperand::Kind)variable.first, variable.second};
+            if (!Liveness::isTracked(*program, v)) {
+                continue;
+            }
+            bool otherReads = false;
+            int64_t test = -1;
+            for (int64_t b : loop.blocks) {
+                const BasicBlock& block = function.blocks[b];
+                for (size_t i = 0; i < block.instructions.size(); i++) {
+                    const IRInstruction& instruction = block.instructions[i];
+                    bool reads = false;
+                    for (const auto& operand : instruction.uses()) {
+                        reads = reads || operand == v;
+                    }
+                    if (!reads || inductionVariables.isStep(Location{b, i})) {
+                        continue;
+                    }
+                    bool sum = (instruction.opcode == IROpcode::ADD && instruction.left == v && inductionVariables.isInvariant(instruction.right))
+                        || (instruction.opcode == IROpcode::ADD && instruction.right == v && inductionVariables.isInvariant(instruction.left))
+                        || (instruction.opcode == IROpcode::SUB && instruction.left == v && inductionVariables.isInvariant(instruction.right));
+                    otherReads = otherReads || !sum;
+                }
+                if (block.left == v || block.right == v) {
+                    const IROperand& other = block.left == v ? block.right : block.left;
+                    otherReads = otherReads || test != -1 || other == v || !inductionVariables.isInvariant(other);
+                    test = b;
+                }
+                for (int64_t successor : block.successors()) {
+                    otherReads = otherReads || (!loop.contains(successor) && liveness.isLiveIn(successor, v));
+                }
+            }
+            if (!otherReads && test != -1) {
+                result[variable] = test;
+            }
+        }
+        return result;
+    }
+
+    // Granica warunku przesunięta tak jak suma: b + k albo b - k
+    IROperand shiftedBound(const IROperand& bound, const Derived& derived, std::vector<IRInstruction>& initialization) {
+        if (bound.isConstant() && derived.invariant.isConstant()) {
+            int64_t shifted = derived.opcode == IROpcode::ADD
+                ? (int64_t)((uint64_t)bound.value + (uint64_t)derived.invariant.value)
+                : (int64_t)((uint64_t)bound.value - (uint64_t)derived.invariant.value);
+            return IROperand::constant(shifted);
+        }
+        IROperand shifted = IROperand::temp(program->tempCount++);
+        initialization.push_back(IRInstruction{derived.opcode, shifted, bound, derived.invariant, -1});
+        return shifted;
+    }
+
+    // Krok sumy r = v * k to krok v razy k; gdy nie jest stały, liczymy go przed pętlą
+    IROperand scaledStep(const IROperand& step, const IROperand& multiplier, std::vector<IRInstruction>& initialization) {
+        if (step.isConstant() && multiplier.isConstant()) {
+            return IROperand::constant((int64_t)((uint64_t)step.value * (uint64_t)multiplier.value));
+        }
+        if (step.isConstant() && step.value == 1) {
+            return multiplier;
+        }
+        IROperand amount = IROperand::temp(program->tempCount++);
+        initialization.push_back(IRInstruction{IROpcode::MUL, amount, step, multiplier, -1});
+        return amount;
+    }
+
+    // Wynik do zmiennej tymczasowej, czytanej tylko dalej w tym samym bloku,
+    // zanim zmieni się zmienna indukcyjna: odczyty biorą od razu sumę
+    static bool renameUses(IRFunction& function, int64_t b, size_t index, const IROperand& running,
+                           const InductionVariables& inductionVariables) {
+        BasicBlock& block = function.blocks[b];
+        const IROperand result = block.instructions[index].result;
+        if (!result.isTemp()) {
+            return false;
+        }
+        size_t definitions = 0;
+        size_t uses = 0;
+        for (const auto& other : function.blocks) {
+            for (const auto& instruction : other.instructions) {
+                if (instruction.definesResult() && instruction.result == result) definitions++;
+                for (const auto& operand : instruction.uses()) {
+                    if (operand == result) uses++;
+                }
+            }
+            if (other.left == result) uses++;
+            if (other.right == result) uses++;
+        }
+        if (definitions != 1) {
+            return false;
+        }
+        size_t local = 0;
+        bool stepped = false;
+        for (size_t i = index + 1; i < block.instructions.size(); i++) {
+            for (const auto& operand : block.instructions[i].uses()) {
+                if (operand == result) {
+                    local++;
+                    if (stepped) return false;
+                }
+            }
+            stepped = stepped || inductionVariables.isStep(Location{b, (size_t)i});
+        }
+        if (block.left == result || block.right == result) {
+            local += (block.left == result) + (block.right == result);
+            if (stepped) return false;
+        }
+        if (local != uses) {
+            return false;
+        }
+        for (size_t i = index + 1; i < block.instructions.size(); i++) {
+            IRInstruction& instruction = block.instructions[i];
+            if (instruction.opcode == IROpcode::STORE && instruction.result == result) instruction.result = running;
+            if (instruction.left == result) instruction.left = running;
+            if (instruction.right == result) instruction.right = running;
+        }
+        if (block.left == result) block.left = running;
+        if (block.right == result) block.right = running;
+        return true;
+    }
+};
+
+#endif // STRENGTH_REDUCTION_HPP
@@ -0,0 +1,28 @@
+#ifndef STRING_INTERNER_HPP
+#define STRING_INTERNER_HPP
+
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+// Pula nazw wspólna dla skanera i parsera. Każda nazwa jest zapisana raz,
+// węzły drzewa trzymają referencje do niej (std::deque nie przenosi napisów).
+class StringInterner {
+public:
+    const std::string& intern(std::string_view text) {
+        auto it = index.find(text);
+        if (it != index.end()) {
+            return *it->second;
+        }
+        const std::string& stored = strings.emplace_back(text);
+        index.emplace(stored, &stored);
+        return stored;
+    }
+
+private:
+    std::deque<std::string> strings;
+    std::unordered_map<std::string_view, const std::string*> index;
+};
+
+#endif // STRING_INTERNER_HPP
@@ -1,63 +1,103 @@
 #include "SymbolTable.hpp"
 #include <algorithm>
+#include <map>
+#include <functional>
+
+int64_t SymbolTable::intern(const std::string& name) {
+    auto it = identifiers.find(name);
+    if (it != identifiers.end()) {
+        return it->second;
+    }
+    int64_t id = identifierNames.size();
+    identifiers.emplace(name, id);
+    identifierNames.push_back(name);
+    return id;
+}
+
+int64_t SymbolTable::find(const std::string& name) const {
+    auto it = identifiers.find(name);
+    return it != identifiers.end() ? it->second : -1;
+}
+
+const std::string& SymbolTable::nameOf(int64_t id) const {
+    return identifierNames[id];
+}
+
+const size_t* SymbolTable::lookup(const Index& index, const std::string& name, const std::string& scope) const {
+    int64_t nameId = find(name);
+    if (nameId == -1 || nameId >= (int64_t)index.size()) {
+        return nullptr;
+    }
+    int64_t scopeId = find(scope);
+    for (const auto& slot : index[nameId]) {
+        if (slot.scope == scopeId) {
+            return &slot.index;
+        }
+    }
+    return nullptr;
+}
+
+bool SymbolTable::insert(Index& index, const std::string& name, const std::string& scope, size_t position) {
+    if (lookup(index, name, scope)) {
+        return false;
+    }
+    int64_t nameId = intern(name);
+    int64_t scopeId = intern(scope);
+    if (nameId >= (int64_t)index.size()) {
+        index.resize(identifierNames.size());
+    }
+    index[nameId].push_back({scopeId, position});
+    return true;
+}
+
+void SymbolTable::erase(Index& index, const std::string& name, const std::string& scope) {
+    auto& slots = index[find(name)];
+    int64_t scopeId = find(scope);
+    slots.erase(std::remove_if(slots.begin(), slots.end(), [&](const Slot& slot) { return slot.scope == scopeId; }), slots.end());
+}
 
 // Dodanie zmiennej do tabeli symboli
 void SymbolTable::addVariable(const std::string& name, const std::string& scope) {
-    std::string key = name + ":" + scope;
-    if (variableExists(name, scope)) {
+    if (!insert(variableIndex, name, scope, variableStore.size())) {
         throw std::runtime_error("Zmienna o tej nazwie już istnieje w tym zakresie!");
     }
-    variables[key] = {name, scope, false, currentMemoryPosition++};
+    variableStore.push_back({name, scope, false, currentMemoryPosition++});
 }
 
 void SymbolTable::addVariable(Variable variable){
-    std::string key = variable.name + ":" + variable.scope;
-    if (variableExists(variable.name, variable.scope)) {
+    if (!insert(variableIndex, variable.name, variable.scope, variableStore.size())) {
         throw std::runtime_error("Zmienna o tej nazwie już istnieje w tym zakresie!");
     }
-    variables[key] = {variable.name, variable.scope, true, currentMemoryPosition++};
+    variableStore.push_back({variable.name, variable.scope, true, currentMemoryPosition++});
 }
 
 // Dodanie tablicy do tabeli symboli
 void SymbolTable::addArray(const std::string& name, const std::string& scope, int64_t startIndex, int64_t endIndex) {
-    std::string key = name + ":" + scope;
-    if (arrayExists(name, scope)) {
+    if (!insert(arrayIndex, name, scope, arrayStore.size())) {
         throw std::runtime_error("Tablica o tej nazwie już istnieje w tym zakresie!");
     }
-    Array newArray = {name, scope, {},{},startIndex, endIndex};
-    for (int64_t i = startIndex; i <= endIndex; ++i) {
-        newArray.memoryPositions[i] = currentMemoryPosition++;
-        newArray.isInitialized[i] = false;
-        if (i == startIndex){
-            newArray.memoryPosition = newArray.memoryPositions[i];
-        }
-    }
-    arrays[key] = newArray;
+    Array newArray = {name, scope, startIndex, endIndex, currentMemoryPosition};
+    currentMemoryPosition += newArray.size();
+    arrayStore.push_back(newArray);
 }
 
 void SymbolTable::addArray(Array array){
-    std::string key = array.name + ":" + array.scope;
-    if (arrayExists(array.name, array.scope)) {
+    if (!insert(arrayIndex, array.name, array.scope, arrayStore.size())) {
         throw std::runtime_error("Tablica o tej nazwie już istnieje w tym zakresie!");
     }
-    Array newArray = {array.name, array.scope, {},{},array.startIndex, array.endIndex};
-    for (int64_t i = array.startIndex; i <= array.endIndex; ++i) {
-        newArray.memoryPositions[i] = currentMemoryPosition++;
-        newArray.isInitialized[i] = true;
-        if (i == array.startIndex){
-            newArray.memoryPosition = newArray.memoryPositions[i];
-        }
-    }
-    arrays[key] = newArray;
+    Array newArray = {array.name, array.scope, array.startIndex, array.endIndex, currentMemoryPosition};
+    newArray.initialized.insert(array.startIndex, array.endIndex);
+    currentMemoryPosition += newArray.size();
+    arrayStore.push_back(newArray);
 }
 
 // Dodanie procedury do tabeli symboli
 void SymbolTable::addProcedure(const std::string& name, const std::string& scope, const std::vector<std::shared_ptr<Param>>& params) {
-    std::string key = name + ":" + scope;
-    if (procedureExists(name, scope)) {
+    if (!insert(procedureIndex, name, scope, procedureStore.size())) {
         throw std::runtime_error("Procedura o tej nazwie już istnieje w tym zakresie!");
     }
     Procedure procedure;
+    procedure.id = procedureStore.size();
     procedure.name = name;
     procedure.scope = scope;
     procedure.params = params;
@@ -67,139 +107,118 @@ void SymbolTable::addProcedure(const std::string& name, const std::string& scope
     returnVariable.isInitialized = true;
     returnVariable.memoryPosition = currentMemoryPosition++;
     procedure.returnVariable = returnVariable;
-    procedures[key] = procedure;
+    procedureStore.push_back(procedure);
 }
 
 void SymbolTable::addProcedureParam(const std::string& procedureName, const std::string& scope, std::shared_ptr<Param> param) {
-    std::string key = procedureName + ":" + scope;
-    if (!procedureExists(procedureName, scope)) {
+    Procedure* procedure = getProcedure(procedureName, scope);
+    if (procedure == nullptr) {
         throw std::runtime_error("Procedura o tej nazwie nie istnieje w tym zakresie!");
     }
-    procedures[key].params.push_back(param);
+    procedure->params.push_back(param);
 }
 
 // Pobieranie zmiennej z tabeli symboli
 Variable* SymbolTable::getVariable(const std::string& name, const std::string& scope) {
-    std::string key = name + ":" + scope;
-    auto it = variables.find(key);
-    if (it != variables.end()) {
-        return &it->second;
-    }
-    return nullptr;
+    const size_t* position = lookup(variableIndex, name, scope);
+    return position ? &variableStore[*position] : nullptr;
 }
 
 // Pobieranie tablicy z tabeli symboli
 Array* SymbolTable::getArray(const std::string& name, const std::string& scope) {
-    std::string key = name + ":" + scope;
-    auto it = arrays.find(key);
-    if (it != arrays.end()) {
-        return &it->second;
-    }
-    return nullptr;
+    const size_t* position = lookup(arrayIndex, name, scope);
+    return position ? &arrayStore[*position] : nullptr;
 }
 
 // Pobieranie procedury z tabeli symboli
 Procedure* SymbolTable::getProcedure(const std::string& name, const std::string& scope) {
-    std::string key = name + ":" + scope;
-    auto it = procedures.find(key);
-    if (it != procedures.end()) {
-        return &it->second;
-    }
-    return nullptr;
+    const size_t* position = lookup(procedureIndex, name, scope);
+    return position ? &procedureStore[*position] : nullptr;
 }
 
+// Usunięty symbol zostaje w magazynie, znika tylko z indeksu
 void SymbolTable::removeVariable(const std::string& name, const std::string& scope) {
-    std::string key = name + ":" + scope; 
-    auto it = variables.find(key);
-    if (it != variables.end()) {
-        variables.erase(it);
-    } else {
+    if (!variableExists(name, scope)) {
         throw std::runtime_error("Variable not found in the specified scope.");
     }
+    erase(variableIndex, name, scope);
 }
 
 void SymbolTable::removeArray(const std::string& name, const std::string& scope) {
-    std::string key = name + ":" + scope; 
-    auto it = arrays.find(key);
-    if (it != arrays.end()) {
-        arrays.erase(it);
-    } else {
+    if (!arrayExists(name, scope)) {
         throw std::runtime_error("Array not found in the specified scope.");
     }
+    erase(arrayIndex, name, scope);
 }
 
 void SymbolTable::removeProcedure(const std::string& name, const std::string& scope) {
-    std::string key = name + ":" + scope; 
-    auto it = procedures.find(key);
-    if (it != procedures.end()) {
-        procedures.erase(it);
-    } else {
+    if (!procedureExists(name, scope)) {
         throw std::runtime_error("Procedure not found in the specified scope.");
     }
+    erase(procedureIndex, name, scope);
 }
 
 
 // Sprawdzanie istnienia zmiennej
 bool SymbolTable::variableExists(const std::string& name, const std::string& scope) {
-    return variables.find(name + ":" + scope) != variables.end();
+    return getVariable(name, scope) != nullptr;
 }
 
 // Sprawdzanie istnienia tablicy
 bool SymbolTable::arrayExists(const std::string& name, const std::string& scope) {
-    return arrays.find(name + ":" + scope) != arrays.end();
+    return getArray(name, scope) != nullptr;
 }
 
 // Sprawdzanie istnienia procedury
 bool SymbolTable::procedureExists(const std::string& name, const std::string& scope) {
-    return procedures.find(name + ":" + scope) != procedures.end();
+    return getProcedure(name, scope) != nullptr;
 }
 
 // Wyświetlenie wszystkich zmiennych w tabeli symboli
 void SymbolTable::printVariables() {
     std::cout << "ZMIENNE:\n";
-    for (const auto& [key, variable] : variables) {
+    forEach(variableIndex, [&](size_t index) {
+        const Variable& variable = variableStore[index];
         std::cout << "Nazwa: " << variable.name
                   << ", Zakres: " << variable.scope
                   << ", Pozycja w pamięci: " << variable.memoryPosition
                   << ", Zainicjalizowana: " << (variable.isInitialized ? "TAK" : "NIE") 
                   << ", Argument: " << (variable.isArgument ? "TAK" : "NIE") << "\n";
-    }
+    });
 }
 
 // Wyświetlenie wszystkich tablic w tabeli symboli
 void SymbolTable::printArrays() {
     std::cout << "TABLICE:\n";
-    for (const auto& [key, array] : arrays) {
+    forEach(arrayIndex, [&](size_t index) {
+        const Array& array = arrayStore[index];
         std::cout << "Nazwa: " << array.name
                   << ", Zakres: " << array.scope
                   << ", Zakres indeksów: [" << array.startIndex << ", " << array.endIndex << "]"
-                  << ", Pozycja w pamięci: " << array.memoryPosition << "\n";
-        for (int64_t i = array.startIndex; i <= array.endIndex; ++i) {
-            std::cout << "  Indeks " << i
-                    << ", Pozycja w pamięci: " << array.memoryPositions.at(i)
-                    << ",  Zainicjalizowana: " << (array.isInitialized.at(i) ? "TAK" : "NIE") 
-                    << ", Argument: " << (array.isArgument ? "TAK" : "NIE") << "\n";
+                  << ", Pozycja w pamięci: " << array.memoryPosition
+                  << ", Argument: " << (array.isArgument ? "TAK" : "NIE") << "\n";
+        for (const auto& [first, last] : array.initialized.getIntervals()) {
+            std::cout << "  Zainicjalizowane indeksy: [" << first << ", " << last << "]"
+                      << ", Pozycje w pamięci: [" << array.positionOf(first) << ", " << array.positionOf(last) << "]\n";
         }
-    }
+    });
 }
 
 // Wyświetlenie wszystkich procedur w tabeli symboli
 void SymbolTable::printProcedures() {
     std::cout << "PROCEDURY:\n";
-    for (const auto& [key, procedure] : procedures) {
+    forEach(procedureIndex, [&](size_t index) {
+        const Procedure& procedure = procedureStore[index];
         std::cout << "Nazwa: " << procedure.name
                   << ", Zakres: " << procedure.scope
                   << ", Parametry: [";
         for (size_t i = 0; i < procedure.params.size(); ++i) {
-            if (auto varParam = std::dynamic_pointer_cast<VariableParam>(procedure.params[i])) {
-                std::cout << varParam->variable.name << "(variable)";
-            } else if (auto arrParam = std::dynamic_pointer_cast<ArrayParam>(procedure.params[i])) {
-                std::cout << arrParam->array.name << "(array)";
-            }
+            const Param& param = *procedure.params[i];
+            std::cout << param.name() << (param.kind == Param::Kind::VARIABLE ? "(variable)" : "(array)");
             if (i != procedure.params.size() - 1) std::cout << ", ";
         }
         std::cout << "]\n";
-    }
+    });
 }
 
 bool SymbolTable::isVariableInProcedureParams(const std::string& procedureName, const std::string& scope, const std::string& variableName) {
@@ -208,16 +227,8 @@ bool SymbolTable::isVariableInProcedureParams(const std::string& procedureName,
         return false;
     }
     for (const auto& param : procedure->params) {
-        if (auto varParam = std::dynamic_pointer_cast<VariableParam>(param)) {
-            if (varParam->variable.name == variableName) {
-                return true;
-            }
-        }
-        // Możemy również sprawdzić tablice, jeśli chcemy
-        else if (auto arrParam = std::dynamic_pointer_cast<ArrayParam>(param)) {
-            if (arrParam->array.name == variableName) {
-                return true;
-            }
+        if (param->name() == variableName) {
+            return true;
         }
     }
     return false;
@@ -234,18 +245,128 @@ bool SymbolTable::isParamsTypeCorrect(const std::string& procedureName, const st
     for (size_t i = 0; i < procedure->params.size(); ++i) {
         const std::string& paramName = params[i];
         if (variableExists(paramName, scope)) {
-            auto variableParam = std::dynamic_pointer_cast<VariableParam>(procedure->params[i]);
-            if (!variableParam) {
+            if (!paramCast<VariableParam>(procedure->params[i])) {
                 return false;
-            } 
+            }
         } else if (arrayExists(paramName, scope)) {
-            auto arrayParam = std::dynamic_pointer_cast<ArrayParam>(procedure->params[i]);
-            if (!arrayParam) {
+            if (!paramCast<ArrayParam>(procedure->params[i])) {
                 return false;
-            } 
+            }
         } else {
             return false;
         }
     }
     return true;
 }
+
+// Procedura biblioteczna kosztuje jedną kopię pętli (ok. 50 rozkazów) plus 5-7 rozkazów na wywołanie,
+// więc opłaca się dopiero od dwóch miejsc użycia. Jedyne miejsce w pętli zostaje rozwinięte,
+// żeby nie płacić narzutu wywołania w każdej iteracji.
+void SymbolTable::addArithmeticSite(const std::string& op, bool insideLoop) {
+    RuntimeRoutine& routine = runtimeRoutines[op];
+    routine.sites++;
+    if (insideLoop) {
+        routine.loopSites++;
+    }
+}
+
+void SymbolTable::planRuntimeRoutines() {
+    for (auto& [op, routine] : runtimeRoutines) {
+        int64_t callSites = routine.sites - (routine.loopSites == 1 ? 1 : 0);
+        if (callSites >= 2 && routine.returnCell == -1) {
+            routine.returnCell = currentMemoryPosition++;
+        }
+    }
+}
+
+bool SymbolTable::hasRuntimeRoutines() const {
+    for (const auto& [op, routine] : runtimeRoutines) {
+        if (routine.returnCell != -1) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool SymbolTable::usesRuntimeRoutine(const std::string& op, bool insideLoop) const {
+    auto it = runtimeRoutines.find(op);
+    if (it == runtimeRoutines.end() || it->second.returnCell == -1) {
+        return false;
+    }
+    return !(insideLoop && it->second.loopSites == 1);
+}
+
+int64_t SymbolTable::allocateCell() {
+    return currentMemoryPosition++;
+}
+
+void SymbolTable::addCall(const std::string& caller, const std::string& callee) {
+    auto& list = callers[callee];
+    if (std::find(list.begin(), list.end(), caller) == list.end()) {
+        list.push_back(caller);
+    }
+}
+
+// Rekurencja jest zabroniona, a procedura może wywołać tylko procedurę
+// zadeklarowaną wcześniej, więc graf wywołań jest acykliczny. Ramka procedury
+// (komórka powrotu, parametry, zmienne i tablice) zaczyna się nad ramkami
+// wszystkich procedur, które ją wywołują; procedury, które nigdy nie są
+// aktywne jednocześnie, dzielą pamięć. Kolejność komórek w ramce się nie zmienia.
+void SymbolTable::overlayFrames() {
+    // Komórki każdego zakresu w dotychczasowej kolejności; tablica zajmuje
+    // endIndex - startIndex + 1 komórek od memoryPosition
+    struct Slot {
+        int64_t* position;
+        Array* array;
+    };
+    std::unordered_map<std::string, std::map<int64_t, Slot>> frames;
+    forEach(variableIndex, [&](size_t index) {
+        Variable& variable = variableStore[index];
+        frames[variable.scope][variable.memoryPosition] = {&variable.memoryPosition, nullptr};
+    });
+    forEach(arrayIndex, [&](size_t index) {
+        Array& array = arrayStore[index];
+        frames[array.scope][array.memoryPosition] = {&array.memoryPosition, &array};
+    });
+    forEach(procedureIndex, [&](size_t index) {
+        Procedure& procedure = procedureStore[index];
+        frames[procedure.name][procedure.returnVariable.memoryPosition] = {&procedure.returnVariable.memoryPosition, nullptr};
+    });
+    auto frameSize = [&](const std::string& scope) {
+        int64_t size = 0;
+        for (const auto& [position, slot] : frames[scope]) {
+            size += slot.array ? slot.array->size() : 1;
+        }
+        return size;
+    };
+
+    // Ramka zaczyna się nad ramkami wywołujących (graf jest acykliczny)
+    std::unordered_map<std::string, int64_t> base;
+    base["MAIN"] = 11;
+    std::function<int64_t(const std::string&)> baseOf = [&](const std::string& scope) {
+        auto it = base.find(scope);
+        if (it != base.end()) {
+            return it->second;
+        }
+        int64_t start = 11;
+        for (const auto& caller : callers[scope]) {
+            start = std::max(start, baseOf(caller) + frameSize(caller));
+        }
+        base[scope] = start;
+        return start;
+    };
+    int64_t end = 11 + frameSize("MAIN");
+    forEach(procedureIndex, [&](size_t index) {
+        const Procedure& procedure = procedureStore[index];
+        end = std::max(end, baseOf(procedure.name) + frameSize(procedure.name));
+    });
+
+    for (auto& [scope, frame] : frames) {
+        int64_t position = baseOf(scope);
+        for (auto& [old, slot] : frame) {
+            *slot.position = position;
+            position += slot.array ? slot.array->size() : 1;
+        }
+    }
+    currentMemoryPosition = end;
+}
@@ -7,6 +7,10 @@
 #include <stdexcept>
 #include <iostream>
 #include <memory>
+#include <deque>
+#include <map>
+#include <algorithm>
+#include "Diagnostics.hpp"
 
 struct Variable {
     std::string name;
@@ -16,34 +20,119 @@ struct Variable {
     bool isArgument = false;
 };
 
-// Struktura dla tablic
+// Zbiór liczb całkowitych jako rozłączne przedziały [początek, koniec];
+// sąsiednie przedziały są łączone
+class IntervalSet {
+public:
+    void insert(int64_t first, int64_t last) {
+        auto it = intervals.upper_bound(first);
+        if (it != intervals.begin() && std::prev(it)->second >= first - 1) {
+            --it;
+            first = it->first;
+        }
+        while (it != intervals.end() && it->first <= last + 1) {
+            last = std::max(last, it->second);
+            it = intervals.erase(it);
+        }
+        intervals[first] = last;
+    }
+
+    void insert(int64_t value) {
+        insert(value, value);
+    }
+
+    bool contains(int64_t value) const {
+        auto it = intervals.upper_bound(value);
+        return it != intervals.begin() && std::prev(it)->second >= value;
+    }
+
+    const std::map<int64_t, int64_t>& getIntervals() const {
+        return intervals;
+    }
+
+private:
+    std::map<int64_t, int64_t> intervals;
+};
+
+// Struktura dla tablic. Elementy zajmują kolejne komórki od memoryPosition,
+// więc adres elementu jest liczony, a nie przechowywany
 struct Array {
     std::string name;
     std::string scope;
-    std::unordered_map<int64_t, int64_t> memoryPositions;
-    std::unordered_map<int64_t, bool> isInitialized ;
-    int64_t startIndex;                               
-    int64_t endIndex;         
+    int64_t startIndex;
+    int64_t endIndex;
     int64_t memoryPosition;
     bool isArgument = false;
+    IntervalSet initialized;    // indeksy elementów, którym nadano wartość
+
+    int64_t size() const {
+        return endIndex - startIndex + 1;
+    }
+
+    int64_t positionOf(int64_t index) const {
+        return memoryPosition + index - startIndex;
+    }
+
+    bool isInitialized(int64_t index) const {
+        return initialized.contains(index);
+    }
+
+    void setInitialized(int64_t index) {
+        initialized.insert(index);
+    }
 };
 
-// Klasa bazowa dla parametrów
+// Klasa bazowa dla parametrów; rodzaj parametru jest znacznikiem,
+// tak jak w węzłach drzewa składniowego
 struct Param {
+    enum class Kind { VARIABLE, ARRAY };
+
+    const Kind kind;
+
+    explicit Param(Kind kind) : kind(kind) {}
     virtual ~Param() = default;
+
+    const std::string& name() const;
 };
 
 // Klasa dla parametrów zmiennych
 struct VariableParam : Param {
+    static constexpr Kind KIND = Kind::VARIABLE;
+
     Variable variable;
+
+    VariableParam() : Param(KIND) {}
 };
 
 // Klasa dla parametrów tablic
 struct ArrayParam : Param {
+    static constexpr Kind KIND = Kind::ARRAY;
+
     Array array;
+
+    ArrayParam() : Param(KIND) {}
+};
+
+// Parametr jako T albo nullptr, gdy jest innego rodzaju
+template <typename T>
+T* paramCast(const std::shared_ptr<Param>& param) {
+    return param && param->kind == T::KIND ? static_cast<T*>(param.get()) : nullptr;
+}
+
+inline const std::string& Param::name() const {
+    return kind == Kind::VARIABLE ? static_cast<const VariableParam*>(this)->variable.name
+                                  : static_cast<const ArrayParam*>(this)->array.name;
+}
+
+// Procedura biblioteki wykonawczej dla operatora *, / lub %
+struct RuntimeRoutine {
+    int64_t sites = 0;
+    int64_t loopSites = 0;
+    int64_t returnCell = -1;
 };
 
 struct Procedure {
+    int64_t id;             // numer w kolejności deklaracji
     std::string name;
     std::vector<std::shared_ptr<Param>> params;
     std::string scope;
@@ -56,6 +145,8 @@ class SymbolTable {
 public:
     std::string iterator = "";
     bool one = false;
+    Diagnostics* diagnostics = nullptr;     // ostrzeżenia analizy, ustawia kontekst kompilacji
+    std::unordered_map<std::string, RuntimeRoutine> runtimeRoutines;
     SymbolTable() : currentMemoryPosition (11) {}
     // Dodawanie zmiennych, procedur i tablic
     void addVariable(const std::string& name, const std::string& scope);
@@ -65,6 +156,10 @@ public:
     void addProcedure(const std::string& name, const std::string& scope, const std::vector<std::shared_ptr<Param>>& params);
     void addProcedureParam(const std::string& procedureName, const std::string& scope, std::shared_ptr<Param> param);
 
+    // Nazwy i zakresy zamieniane na liczby (wspólna numeracja)
+    int64_t intern(const std::string& name);
+    const std::string& nameOf(int64_t id) const;
+
     // Pobieranie zmiennych, procedur i tablic
     Variable* getVariable(const std::string& name, const std::string& scope);
     Array* getArray(const std::string& name, const std::string& scope);
@@ -87,11 +182,59 @@ public:
 
     bool isVariableInProcedureParams(const std::string& procedureName, const std::string& scope, const std::string& variableName);
     bool isParamsTypeCorrect(const std::string& procedureName, const std::string& scope, const std::vector<std::string>& params);
+
+    // Wybór między rozwinięciem mnożenia/dzielenia w miejscu a wywołaniem procedury bibliotecznej
+    void addArithmeticSite(const std::string& op, bool insideLoop);
+    void planRuntimeRoutines();
+    bool hasRuntimeRoutines() const;
+    bool usesRuntimeRoutine(const std::string& op, bool insideLoop) const;
+
+    // Nowa komórka pamięci, np. dla zmiennej tymczasowej
+    int64_t allocateCell();
+
+    // Graf wywołań i nakładanie ramek procedur, które nie mogą być aktywne jednocześnie
+    void addCall(const std::string& caller, const std::string& callee);
+    void overlayFrames();
 private:
-    std::unordered_map<std::string, Variable> variables;
-    std::unordered_map<std::string, Array> arrays;
-    std::unordered_map<std::string, Procedure> procedures;
+    // Symbole leżą w std::deque (wskaźniki zwracane przez get* pozostają ważne
+    // po dodaniu kolejnych). Indeks to wektor numerowany identyfikatorem nazwy;
+    // pod każdą nazwą są symbole z zakresów, w których ją zadeklarowano (zwykle
+    // jeden lub dwa). Wyszukiwanie po nazwach nie tworzy nowych napisów.
+    struct Slot {
+        int64_t scope;
+        size_t index;       // pozycja w magazynie
+    };
+    using Index = std::vector<std::vector<Slot>>;
+
+    std::unordered_map<std::string, int64_t> identifiers;
+    std::vector<std::string> identifierNames;
+    std::deque<Variable> variableStore;
+    std::deque<Array> arrayStore;
+    std::deque<Procedure> procedureStore;
+    Index variableIndex;
+    Index arrayIndex;
+    Index procedureIndex;
+    std::unordered_map<std::string, std::vector<std::string>> callers;    // procedura -> zakresy, które ją wywołują
     int64_t currentMemoryPosition ;
+
+    // Identyfikator nazwy albo -1, gdy nazwa nie wystąpiła
+    int64_t find(const std::string& name) const;
+
+    // Pozycja symbolu w magazynie albo nullptr
+    const size_t* lookup(const Index& index, const std::string& name, const std::string& scope) const;
+    // Fałsz, gdy symbol o tej nazwie już jest w tym zakresie
+    bool insert(Index& index, const std::string& name, const std::string& scope, size_t position);
+    void erase(Index& index, const std::string& name, const std::string& scope);
+
+    // Wywołuje visit(pozycja) dla każdego symbolu w indeksie
+    template <typename Visit>
+    static void forEach(const Index& index, Visit visit) {
+        for (const auto& slots : index) {
+            for (const auto& slot : slots) {
+                visit(slot.index);
+            }
+        }
+    }
 };
 
 #endif // SYMBOL_TABLE_HPP
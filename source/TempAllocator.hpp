@@ -0,0 +1,89 @@
+#ifndef TEMP_ALLOCATOR_HPP
+#define TEMP_ALLOCATOR_HPP
+
+#include <map>
+#include <set>
+#include <vector>
+#include "IR.hpp"
+#include "Liveness.hpp"
+
+// Przydział miejsc zmiennym tymczasowym procedury według czasu życia. Dwie
+// zmienne kolidują, gdy jedna jest definiowana, kiedy druga jest żywa;
+// zmienne, które nie kolidują, dostają to samo miejsce (kolorowanie
+// zachłanne w kolejności pierwszego wystąpienia). Miejsca są numerowane od 0,
+// komórki przydziela im wybór rozkazów.
+class TempAllocator {
+public:
+    TempAllocator(const IRProgram& program, const IRFunction& function) {
+        Liveness liveness(program, function);
+        std::map<int64_t, std::set<int64_t>> interference;
+        std::vector<int64_t> order;
+        std::set<int64_t> seen;
+        auto note = [&](const IROperand& operand) {
+            if (operand.isTemp() && seen.insert(operand.value).second) {
+                order.push_back(operand.value);
+            }
+        };
+
+        for (const auto& block : function.blocks) {
+            for (const auto& instruction : block.instructions) {
+                note(instruction.result);
+                note(instruction.left);
+                note(instruction.right);
+            }
+            note(block.left);
+            note(block.right);
+
+            std::set<int64_t> live;
+            for (const auto& [kind, value] : liveness.getLiveOut(block.id)) {
+                if (kind == IROperand::TEMP) {
+                    live.insert(value);
+                }
+            }
+            for (const auto& operand : {block.left, block.right}) {
+                if (operand.isTemp()) {
+                    live.insert(operand.value);
+                }
+            }
+            for (auto it = block.instructions.rbegin(); it != block.instructions.rend(); ++it) {
+                if (it->definesResult() && it->result.isTemp()) {
+                    int64_t defined = it->result.value;
+                    live.erase(defined);
+                    for (int64_t other : live) {
+                        interference[defined].insert(other);
+                        interference[other].insert(defined);
+                    }
+                }
+                for (const auto& operand : it->uses()) {
+                    if (operand.isTemp()) {
+                        live.insert(operand.value);
+                    }
+                }
+            }
+        }
+
+        for (int64_t temp : order) {
+            std::set<int64_t> taken;
+            for (int64_t other : interference[temp]) {
+                auto it = slots.find(other);
+                if (it != slots.end()) {
+                    taken.insert(it->second);
+                }
+            }
+            int64_t slot = 0;
+            while (taken.count(slot)) {
+                slot++;
+            }
+            slots[temp] = slot;
+        }
+    }
+
+    int64_t slotOf(int64_t temp) const {
+        return slots.at(temp);
+    }
+
+private:
+    std::map<int64_t, int64_t> slots;
+};
+
+#endif // TEMP_ALLOCATOR_HPP
@@ -0,0 +1,79 @@
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Pula wątków z podkradaniem pracy dla zadań znanych z góry (pliki w trybie
+// --batch). Zadania są rozdzielane po równo między kolejki wątków; wątek
+// bierze zadania z końca swojej kolejki, a gdy ta się opróżni, podkrada
+// z początku kolejek pozostałych wątków. Zadania nie tworzą nowych zadań,
+// więc wątek, który nigdzie nie znalazł pracy, może skończyć.
+class WorkStealingPool {
+public:
+    explicit WorkStealingPool(std::size_t threads = std::thread::hardware_concurrency())
+        : queues(std::max<std::size_t>(threads, 1)) {}
+
+    std::size_t size() const {
+        return queues.size();
+    }
+
+    // Wywołuje task(i) dla i = 0 .. count - 1 i czeka na zakończenie wszystkich
+    void run(std::size_t count, const std::function<void(std::size_t)>& task) {
+        for (std::size_t i = 0; i < count; i++) {
+            queues[i % queues.size()].tasks.push_back(i);
+        }
+        std::vector<std::thread> workers;
+        for (std::size_t worker = 1; worker < std::min(queues.size(), count); worker++) {
+            workers.emplace_back([this, worker, &task] { work(worker, task); });
+        }
+        work(0, task);
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<std::size_t> tasks;
+    };
+
+    std::vector<Queue> queues;
+
+    bool take(std::size_t worker, std::size_t& task) {
+        {
+            Queue& own = queues[worker];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            if (!own.tasks.empty()) {
+                task = own.tasks.back();
+                own.tasks.pop_back();
+                return true;
+            }
+        }
+        for (std::size_t k = 1; k < queues.size(); k++) {
+            Queue& victim = queues[(worker + k) % queues.size()];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.tasks.empty()) {
+                task = victim.tasks.front();
+                victim.tasks.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void work(std::size_t worker, const std::function<void(std::size_t)>& task) {
+        std::size_t next;
+        while (take(worker, next)) {
+            task(next);
+        }
+    }
+};
+
+#endif // THREAD_POOL_HPP
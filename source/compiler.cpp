@@ -1,48 +1,114 @@
 #include <iostream>
 #include <fstream>
-#include <unordered_set>
-#include "AST.hpp"
+#include <sstream>
+#include <filesystem>
+#include <algorithm>
+#include "Impc.hpp"
+#include "ThreadPool.hpp"
 
-extern int yyparse();
-extern std::unique_ptr<ASTNode> root;
-SymbolTable symbolTable;
-CodeGenerator codeGenerator;
-
-int main(int argc, char** argv) {
-    if (argc < 3 ) {
-        std::cerr << "Usage: " << argv[0] << " <input_file> <output_file>" << std::endl;
+// Kompilacja jednego pliku, komunikaty trafiają do diagnostics.
+// Zwraca 0, gdy kod został zapisany, w przeciwnym razie 1.
+static int compile(const std::string& inputFile, const std::string& outputFile, std::ostream& diagnostics) {
+    std::ifstream input(inputFile, std::ios::binary);
+    if (!input.is_open()) {
+        diagnostics << "Could not open input file: " << inputFile << std::endl;
         return 1;
     }
+    std::ostringstream source;
+    source << input.rdbuf();
 
-    std::ifstream input(argv[1]);
-    if (!input.is_open()) {
-        std::cerr << "Could not open input file: " << argv[1] << std::endl;
+    CompilationResult result = compileSource(source.str());
+    Diagnostics::print(diagnostics, result.diagnostics);
+    if (!result.success) {
         return 1;
     }
 
-    std::ofstream output(argv[2]);
+    std::ofstream output(outputFile);
     if (!output.is_open()) {
-        std::cerr << "Could not open output file: " << argv[2] << std::endl;
+        diagnostics << "Could not open output file: " << outputFile << std::endl;
         return 1;
     }
+    writeCommands(output, result.code);
+    return 0;
+}
 
-    extern FILE* yyin;
-    yyin = fopen(argv[1], "r");
-    if (!yyin) {
-        std::cerr << "Failed to open input file for parsing.\n";
+// Tryb --batch: pliki (katalog oznacza wszystkie jego pliki .imp) są
+// kompilowane równolegle do plików .mr obok źródeł albo w katalogu po -o.
+// Komunikaty każdego pliku są zbierane osobno i wypisywane w kolejności
+// plików na wejściu, niezależnie od kolejności kompilacji.
+static int compileBatch(int argc, char** argv) {
+    namespace fs = std::filesystem;
+    std::vector<fs::path> inputs;
+    fs::path outputDirectory;
+    for (int i = 2; i < argc; i++) {
+        std::string argument = argv[i];
+        if (argument == "-o" && i + 1 < argc) {
+            outputDirectory = argv[++i];
+            continue;
+        }
+        std::error_code error;
+        if (fs::is_directory(argument, error)) {
+            std::vector<fs::path> files;
+            for (const auto& entry : fs::directory_iterator(argument, error)) {
+                if (entry.is_regular_file() && entry.path().extension() == ".imp") {
+                    files.push_back(entry.path());
+                }
+            }
+            std::sort(files.begin(), files.end());
+            inputs.insert(inputs.end(), files.begin(), files.end());
+        } else {
+            inputs.push_back(argument);
+        }
+    }
+    if (inputs.empty()) {
+        std::cerr << "Usage: " << argv[0] << " --batch [-o <output_dir>] <input_file|input_dir>..." << std::endl;
         return 1;
     }
+    if (!outputDirectory.empty()) {
+        std::error_code error;
+        fs::create_directories(outputDirectory, error);
+    }
 
-    if (yyparse() == 0 && root) {
-        try{
-            root->traverseAndAnalyze(symbolTable,"GLOBAL");
-        } catch (const std::runtime_error& e) {
-            std::cerr << e.what() << std::endl;
-            return 1;
+    std::vector<std::string> diagnostics(inputs.size());
+    std::vector<int> results(inputs.size(), 1);
+    WorkStealingPool pool;
+    pool.run(inputs.size(), [&](std::size_t i) {
+        fs::path output = inputs[i];
+        output.replace_extension(".mr");
+        if (!outputDirectory.empty()) {
+            output = outputDirectory / output.filename();
+        }
+        std::ostringstream messages;
+        try {
+            results[i] = compile(inputs[i].string(), output.string(), messages);
+        } catch (const std::exception& e) {
+            messages << e.what() << std::endl;
         }
+        diagnostics[i] = messages.str();
+    });
 
-        root->generateCode(codeGenerator, symbolTable, "GLOBAL");
-        codeGenerator.saveToFile(argv[2]);
-    } 
-    return 0;
+    size_t failed = 0;
+    for (std::size_t i = 0; i < inputs.size(); i++) {
+        if (!diagnostics[i].empty()) {
+            std::cerr << inputs[i].string() << ":\n" << diagnostics[i];
+        }
+        if (results[i] != 0) {
+            std::cerr << inputs[i].string() << ": compilation failed" << std::endl;
+            failed++;
+        }
+    }
+    std::cout << inputs.size() - failed << " of " << inputs.size() << " files compiled" << std::endl;
+    return failed == 0 ? 0 : 1;
+}
+
+int main(int argc, char** argv) {
+    if (argc >= 2 && std::string(argv[1]) == "--batch") {
+        return compileBatch(argc, argv);
+    }
+    if (argc < 3 ) {
+        std::cerr << "Usage: " << argv[0] << " <input_file> <output_file>" << std::endl;
+        std::cerr << "       " << argv[0] << " --batch [-o <output_dir>] <input_file|input_dir>..." << std::endl;
+        return 1;
+    }
+    return compile(argv[1], argv[2], std::cerr);
 }
@@ -1,28 +1,38 @@
+%code requires {
+#include <string>
+typedef void* yyscan_t;
+struct CompilationContext;
+}
+
 %{
 #include <iostream>
 #include <memory>
 #include "AST.hpp"
+#include "CompilationContext.hpp"
 #include <cstdint>
 
-extern int yylex();
-extern void yyerror(const char *s);
-extern int yylineno;
-extern std::string currentLine;
-extern char* yytext;
-
-std::unique_ptr<ASTNode> root;
-
 inline ASTNode* cast(void* ptr) { return static_cast<ASTNode*>(ptr); }
 inline void* to_void(ASTNode* node) { return static_cast<void*>(node); }
 
 %}
 
+%define api.pure full
+%lex-param {yyscan_t scanner}
+%parse-param {yyscan_t scanner} {CompilationContext& context}
+
 %union {
-    char* str;
+    const std::string* str;
     int64_t num;
     void* node;
 }
 
+%code {
+int yylex(YYSTYPE* yylval, yyscan_t scanner);
+char* yyget_text(yyscan_t scanner);
+int yyget_lineno(yyscan_t scanner);
+void yyerror(yyscan_t scanner, CompilationContext& context, const char* s);
+}
+
 %token <str> pidentifier 
 %token <num> NUM
 %token PROGRAM PROCEDURE PROGRAM_BEGIN END IS IF ELSE ENDIF THEN 
@@ -41,30 +51,30 @@ inline void* to_void(ASTNode* node) { return static_cast<void*>(node); }
 
 program_all:
     procedures main {
-        auto programNode = new ProgramNode(
-            std::unique_ptr<ASTNode>(cast($1)),
-            std::unique_ptr<ASTNode>(cast($2))
+        auto programNode = context.astArena.make<ProgramNode>(
+            cast($1),
+            cast($2)
         );
-        root = std::unique_ptr<ASTNode>(programNode);
+        context.root = programNode;
     }
     ;
 
 procedures:
     procedures PROCEDURE proc_head IS declarations PROGRAM_BEGIN commands END {
-        auto procedureNode = new ProcedureNode(
-            std::unique_ptr<ASTNode>(cast($1)),
-            std::unique_ptr<ProcHeadNode>(static_cast<ProcHeadNode*>($3)),
-            std::unique_ptr<ASTNode>(cast($5)),
-            std::unique_ptr<ASTNode>(cast($7))
+        auto procedureNode = context.astArena.make<ProcedureNode>(
+            cast($1),
+            static_cast<ProcHeadNode*>($3),
+            cast($5),
+            cast($7)
         );
         $$ = to_void(procedureNode);
     }
     | procedures PROCEDURE proc_head IS PROGRAM_BEGIN commands END {
-        auto procedureNode = new ProcedureNode(
-            std::unique_ptr<ASTNode>(cast($1)),
-            std::unique_ptr<ProcHeadNode>(static_cast<ProcHeadNode*>($3)),
+        auto procedureNode = context.astArena.make<ProcedureNode>(
+            cast($1),
+            static_cast<ProcHeadNode*>($3),
             nullptr,
-            std::unique_ptr<ASTNode>(cast($6))
+            cast($6)
         );
         $$ = to_void(procedureNode);
     }
@@ -75,16 +85,16 @@ procedures:
 
 main:
     PROGRAM IS declarations PROGRAM_BEGIN commands END { 
-        auto mainNode = new MainNode(
-            std::unique_ptr<ASTNode>(cast($3)),
-            std::unique_ptr<ASTNode>(cast($5))
+        auto mainNode = context.astArena.make<MainNode>(
+            cast($3),
+            cast($5)
         );
         $$ = to_void(mainNode);
     }
     | PROGRAM IS PROGRAM_BEGIN commands END {
-        auto mainNode = new MainNode(
-            std::unique_ptr<ASTNode>(cast(nullptr)),
-            std::unique_ptr<ASTNode>(cast($4))
+        auto mainNode = context.astArena.make<MainNode>(
+            nullptr,
+            cast($4)
         );
         $$ = to_void(mainNode);
     }
@@ -92,92 +102,92 @@ main:
 
 commands:
     commands command {
-        auto commandsNode = dynamic_cast<CommandsNode*>(cast($1));
+        auto commandsNode = nodeCast<CommandsNode>(cast($1));
         if (!commandsNode) {
-            yyerror("Invalid cast to CommandsNode");
+            yyerror(scanner, context, "Invalid cast to CommandsNode");
             YYABORT;
         }
-        commandsNode->addCommand(std::unique_ptr<ASTNode>(cast($2)));
+        commandsNode->addCommand(cast($2));
         $$ = to_void(commandsNode);
     }
     | command {
-        auto commandsNode = new CommandsNode();
-        commandsNode->addCommand(std::unique_ptr<ASTNode>(cast($1)));
+        auto commandsNode = context.astArena.make<CommandsNode>();
+        commandsNode->addCommand(cast($1));
         $$ = to_void(commandsNode);
     }
     ;
 
 command:
     identifier ASSIGN expression SEMICOLON {
-        auto assignmentNode = new AssignmentNode(
-            std::unique_ptr<ASTNode>(cast($1)),
-            std::unique_ptr<ASTNode>(cast($3))
+        auto assignmentNode = context.astArena.make<AssignmentNode>(
+            cast($1),
+            cast($3)
         );
         $$ = to_void(assignmentNode);
     }
     | IF condition THEN commands ELSE commands ENDIF {
-        auto ifNode = new IfNode(
-            std::unique_ptr<ASTNode>(cast($2)),
-            std::unique_ptr<ASTNode>(cast($4)),
-            std::unique_ptr<ASTNode>(cast($6))
+        auto ifNode = context.astArena.make<IfNode>(
+            cast($2),
+            cast($4),
+            cast($6)
         );
         $$ = to_void(ifNode);
     }
     | IF condition THEN commands ENDIF {
-        auto ifNode = new IfNode(
-            std::unique_ptr<ASTNode>(cast($2)),
-            std::unique_ptr<ASTNode>(cast($4)),
-            std::unique_ptr<ASTNode>(cast(nullptr))
+        auto ifNode = context.astArena.make<IfNode>(
+            cast($2),
+            cast($4),
+            nullptr
         );
         $$ = to_void(ifNode);
     }
     | WHILE condition DO commands ENDWHILE {
-        auto whileNode = new WhileNode(
-            std::unique_ptr<ASTNode>(cast($2)),
-            std::unique_ptr<ASTNode>(cast($4))
+        auto whileNode = context.astArena.make<WhileNode>(
+            cast($2),
+            cast($4)
         );
         $$ = to_void(whileNode);
     }
     | REPEAT commands UNTIL condition SEMICOLON {
-        auto repeatNode = new RepeatNode(
-            std::unique_ptr<ASTNode>(cast($2)),
-            std::unique_ptr<ASTNode>(cast($4))
+        auto repeatNode = context.astArena.make<RepeatNode>(
+            cast($2),
+            cast($4)
         );
         $$ = to_void(repeatNode);
     }
     | FOR pidentifier FROM value TO value DO commands ENDFOR {
-        auto forToNode = new ForToNode(
-            $2,
-            std::unique_ptr<ASTNode>(cast($4)),
-            std::unique_ptr<ASTNode>(cast($6)),
-            std::unique_ptr<ASTNode>(cast($8))
+        auto forToNode = context.astArena.make<ForToNode>(
+            *$2,
+            cast($4),
+            cast($6),
+            cast($8)
         );
         $$ = to_void(forToNode);
     }
     | FOR pidentifier FROM value DOWNTO value DO commands ENDFOR {
-        auto forDownToNode = new ForDownToNode(
-            $2,
-            std::unique_ptr<ASTNode>(cast($4)),
-            std::unique_ptr<ASTNode>(cast($6)),
-            std::unique_ptr<ASTNode>(cast($8))
+        auto forDownToNode = context.astArena.make<ForDownToNode>(
+            *$2,
+            cast($4),
+            cast($6),
+            cast($8)
         );
         $$ = to_void(forDownToNode);
     }
     | proc_call SEMICOLON {
-        auto procallCommandNode = new ProcallCommandNode(
-            std::unique_ptr<ASTNode>(cast($1))
+        auto procallCommandNode = context.astArena.make<ProcallCommandNode>(
+            cast($1)
         );
         $$ = to_void(procallCommandNode);
     }
     | READ identifier SEMICOLON {
-        auto readNode = new ReadNode(
-            std::unique_ptr<ASTNode>(cast($2))
+        auto readNode = context.astArena.make<ReadNode>(
+            cast($2)
         );
         $$ = to_void(readNode);
     }
     | WRITE value SEMICOLON {
-        auto writeNode = new WriteNode(
-            std::unique_ptr<ASTNode>(cast($2))
+        auto writeNode = context.astArena.make<WriteNode>(
+            cast($2)
         );
         $$ = to_void(writeNode);  
     }
@@ -185,9 +195,9 @@ command:
 
 proc_head:
     pidentifier LPAREN args_decl RPAREN {
-        auto procHeadNode = new ProcHeadNode(
-            $1,
-            std::unique_ptr<ASTNode>(cast($3))
+        auto procHeadNode = context.astArena.make<ProcHeadNode>(
+            *$1,
+            cast($3)
         );
         $$ = to_void(procHeadNode);  
     }
@@ -195,9 +205,9 @@ proc_head:
 
 proc_call:
     pidentifier LPAREN args RPAREN {
-        auto procCallNode  = new ProcCallNode (
-            $1,
-            std::unique_ptr<ASTNode>(cast($3))       
+        auto procCallNode  = context.astArena.make<ProcCallNode>(
+            *$1,
+            cast($3)       
         );
         $$ = to_void(procCallNode );  
     }
@@ -205,64 +215,64 @@ proc_call:
 
 declarations:
     declarations COMMA pidentifier {
-        auto declarationsNode = new DeclarationsNode();
-        auto declarationNode = new DeclarationNode($3);
-        declarationsNode->addDeclaration(std::unique_ptr<ASTNode>(cast(declarationNode)));
-        declarationsNode->addDeclaration(std::unique_ptr<ASTNode>(cast($1)));
+        auto declarationsNode = context.astArena.make<DeclarationsNode>();
+        auto declarationNode = context.astArena.make<DeclarationNode>(*$3);
+        declarationsNode->addDeclaration(declarationNode);
+        declarationsNode->addDeclaration(cast($1));
         $$ = to_void(declarationsNode);
     }
     | declarations COMMA pidentifier LBRACKET NUM_T COLON NUM_T RBRACKET {
-        auto declarationsNode = new DeclarationsNode();
-        auto declarationNode = new DeclarationNode($3, $5, $7);
-        declarationsNode->addDeclaration(std::unique_ptr<ASTNode>(cast(declarationNode)));
-        declarationsNode->addDeclaration(std::unique_ptr<ASTNode>(cast($1)));
+        auto declarationsNode = context.astArena.make<DeclarationsNode>();
+        auto declarationNode = context.astArena.make<DeclarationNode>(*$3, $5, $7);
+        declarationsNode->addDeclaration(declarationNode);
+        declarationsNode->addDeclaration(cast($1));
         $$ = to_void(declarationsNode);
     }
     | pidentifier {
-        auto declarationNode = new DeclarationNode($1);
+        auto declarationNode = context.astArena.make<DeclarationNode>(*$1);
         $$ = to_void(declarationNode);
     }   
     | pidentifier LBRACKET NUM_T COLON NUM_T RBRACKET {
-        auto declarationNode = new DeclarationNode($1, $3, $5);
+        auto declarationNode = context.astArena.make<DeclarationNode>(*$1, $3, $5);
         $$ = to_void(declarationNode);
     }
     ;
 
 args_decl:
     args_decl COMMA pidentifier {
-        auto argsdeclsNode = new ArgsdeclsNode();
-        auto argsdeclNode = new ArgsdeclNode($3);
-        argsdeclsNode->addArgsdecl(std::unique_ptr<ASTNode>(cast(argsdeclNode)));
-        argsdeclsNode->addArgsdecl(std::unique_ptr<ASTNode>(cast($1)));
+        auto argsdeclsNode = context.astArena.make<ArgsdeclsNode>();
+        auto argsdeclNode = context.astArena.make<ArgsdeclNode>(*$3);
+        argsdeclsNode->addArgsdecl(argsdeclNode);
+        argsdeclsNode->addArgsdecl(cast($1));
         $$ = to_void(argsdeclsNode);
     }
     | args_decl COMMA T pidentifier {
-        auto argsdeclsNode = new ArgsdeclsNode();
-        auto argsdeclNode = new ArgsdeclNode($4, true);
-        argsdeclsNode->addArgsdecl(std::unique_ptr<ASTNode>(cast(argsdeclNode)));
-        argsdeclsNode->addArgsdecl(std::unique_ptr<ASTNode>(cast($1)));
+        auto argsdeclsNode = context.astArena.make<ArgsdeclsNode>();
+        auto argsdeclNode = context.astArena.make<ArgsdeclNode>(*$4, true);
+        argsdeclsNode->addArgsdecl(argsdeclNode);
+        argsdeclsNode->addArgsdecl(cast($1));
         $$ = to_void(argsdeclsNode);
     }
     | pidentifier {
-        auto argsdeclNode = new ArgsdeclNode($1);
+        auto argsdeclNode = context.astArena.make<ArgsdeclNode>(*$1);
         $$ = to_void(argsdeclNode);
     }
     | T pidentifier {
-        auto argsdeclNode = new ArgsdeclNode($2, true);
+        auto argsdeclNode = context.astArena.make<ArgsdeclNode>(*$2, true);
         $$ = to_void(argsdeclNode);
     }
     ;
     
 args:
     args COMMA pidentifier{
-        auto argsNode = new ArgsNode();
-        auto argNode = new ArgNode($3);
-        argsNode->addArg(std::unique_ptr<ASTNode>(cast(argNode)));
-        argsNode->addArg(std::unique_ptr<ASTNode>(cast($1)));
+        auto argsNode = context.astArena.make<ArgsNode>();
+        auto argNode = context.astArena.make<ArgNode>(*$3);
+        argsNode->addArg(argNode);
+        argsNode->addArg(cast($1));
         $$ = to_void(argsNode);
     }
     | pidentifier {
-        auto argNode = new ArgNode($1);
+        auto argNode = context.astArena.make<ArgNode>(*$1);
         $$ = to_void(argNode);
     }
     ;
@@ -272,42 +282,42 @@ expression:
         $$ = $1; 
     }
     | value PLUS value {
-        auto expressionNode = new ExpressionNode(
-            std::unique_ptr<ASTNode>(cast($1)), 
-            "+", 
-            std::unique_ptr<ASTNode>(cast($3))
+        auto expressionNode = context.astArena.make<ExpressionNode>(
+            cast($1), 
+            ArithmeticOperator::PLUS, 
+            cast($3)
         );
         $$ = to_void(expressionNode);  // Dodajemy poprawnie węzeł
     }
     | value MINUS value {
-        auto expressionNode = new ExpressionNode(
-            std::unique_ptr<ASTNode>(cast($1)), 
-            "-", 
-            std::unique_ptr<ASTNode>(cast($3))
+        auto expressionNode = context.astArena.make<ExpressionNode>(
+            cast($1), 
+            ArithmeticOperator::MINUS, 
+            cast($3)
         );
         $$ = to_void(expressionNode);  // Dodajemy poprawnie węzeł
     }
     | value MULTIPLY value {
-        auto expressionNode = new ExpressionNode(
-            std::unique_ptr<ASTNode>(cast($1)), 
-            "*", 
-            std::unique_ptr<ASTNode>(cast($3))
+        auto expressionNode = context.astArena.make<ExpressionNode>(
+            cast($1), 
+            ArithmeticOperator::MULTIPLY, 
+            cast($3)
         );
         $$ = to_void(expressionNode);  // Dodajemy poprawnie węzeł
     }
     | value DIVIDE value {
-        auto expressionNode = new ExpressionNode(
-            std::unique_ptr<ASTNode>(cast($1)), 
-            "/", 
-            std::unique_ptr<ASTNode>(cast($3))
+        auto expressionNode = context.astArena.make<ExpressionNode>(
+            cast($1), 
+            ArithmeticOperator::DIVIDE, 
+            cast($3)
         );
         $$ = to_void(expressionNode);  // Dodajemy poprawnie węzeł
     }
     | value MODULO value {
-        auto expressionNode = new ExpressionNode(
-            std::unique_ptr<ASTNode>(cast($1)), 
-            "%", 
-            std::unique_ptr<ASTNode>(cast($3))
+        auto expressionNode = context.astArena.make<ExpressionNode>(
+            cast($1), 
+            ArithmeticOperator::MODULO, 
+            cast($3)
         );
         $$ = to_void(expressionNode);  // Dodajemy poprawnie węzeł
     }
@@ -316,50 +326,50 @@ expression:
 
 condition:
     value EQUAL value {
-    	auto conditionNode = new ConditionNode(
-            std::unique_ptr<ASTNode>(cast($1)), 
-            "=", 
-            std::unique_ptr<ASTNode>(cast($3))
+    	auto conditionNode = context.astArena.make<ConditionNode>(
+            cast($1), 
+            RelationalOperator::EQUAL, 
+            cast($3)
         );
         $$ = to_void(conditionNode);  // Dodajemy poprawnie węzeł
     }
     | value NOTEQUAL value {
-    	auto conditionNode = new ConditionNode(
-            std::unique_ptr<ASTNode>(cast($1)), 
-            "!=", 
-            std::unique_ptr<ASTNode>(cast($3))
+    	auto conditionNode = context.astArena.make<ConditionNode>(
+            cast($1), 
+            RelationalOperator::NOTEQUAL, 
+            cast($3)
         );
         $$ = to_void(conditionNode);  // Dodajemy poprawnie węzeł
     }
     | value GREATER value {
-    	auto conditionNode = new ConditionNode(
-            std::unique_ptr<ASTNode>(cast($1)), 
-            ">", 
-            std::unique_ptr<ASTNode>(cast($3))
+    	auto conditionNode = context.astArena.make<ConditionNode>(
+            cast($1), 
+            RelationalOperator::GREATER, 
+            cast($3)
         );
         $$ = to_void(conditionNode);  // Dodajemy poprawnie węzeł
     }
     | value LESS value {
-    	auto conditionNode = new ConditionNode(
-            std::unique_ptr<ASTNode>(cast($1)), 
-            "<", 
-            std::unique_ptr<ASTNode>(cast($3))
+    	auto conditionNode = context.astArena.make<ConditionNode>(
+            cast($1), 
+            RelationalOperator::LESS, 
+            cast($3)
         );
         $$ = to_void(conditionNode);  // Dodajemy poprawnie węzeł
     }
     | value GREATEREQUAL value {
-    	auto conditionNode = new ConditionNode(
-            std::unique_ptr<ASTNode>(cast($1)), 
-            ">=", 
-            std::unique_ptr<ASTNode>(cast($3))
+    	auto conditionNode = context.astArena.make<ConditionNode>(
+            cast($1), 
+            RelationalOperator::GREATEREQUAL, 
+            cast($3)
         );
         $$ = to_void(conditionNode);  // Dodajemy poprawnie węzeł
     }
     | value LESSEQUAL value {
-    	auto conditionNode = new ConditionNode(
-            std::unique_ptr<ASTNode>(cast($1)), 
-            "<=", 
-            std::unique_ptr<ASTNode>(cast($3))
+    	auto conditionNode = context.astArena.make<ConditionNode>(
+            cast($1), 
+            RelationalOperator::LESSEQUAL, 
+            cast($3)
         );
         $$ = to_void(conditionNode);  // Dodajemy poprawnie węzeł
     }
@@ -367,26 +377,26 @@ condition:
 
 value:
     NUM_T {
-        auto valueNode = new ValueNode($1);
+        auto valueNode = context.astArena.make<ValueNode>($1);
         $$ = to_void(valueNode);
     }
     | identifier {
-        auto valueNode = new ValueNode(std::unique_ptr<ASTNode>(cast($1)));
+        auto valueNode = context.astArena.make<ValueNode>(cast($1));
         $$ = to_void(valueNode);
     }
     ;
 
 identifier:
     pidentifier {
-        auto identifierNode = new IdentifierNode($1);
+        auto identifierNode = context.astArena.make<IdentifierNode>(*$1);
         $$ = to_void(identifierNode);
     }
     | pidentifier LBRACKET pidentifier RBRACKET {
-        auto identifierNode = new IdentifierNode($1, $3);
+        auto identifierNode = context.astArena.make<IdentifierNode>(*$1, *$3);
         $$ = to_void(identifierNode);
     }
     | pidentifier LBRACKET NUM_T RBRACKET {
-        auto identifierNode = new IdentifierNode($1, $3);
+        auto identifierNode = context.astArena.make<IdentifierNode>(*$1, $3);
         $$ = to_void(identifierNode);
     }
     ;
@@ -402,8 +412,7 @@ NUM_T:
 
 %%
 
-void yyerror(const char *s) {
-    std::cerr << "Syntax error: "<< yytext << std::endl;
-    std::cerr << yylineno <<"  | "<< currentLine << std::endl;
+void yyerror(yyscan_t scanner, CompilationContext& context, const char *s) {
+    context.diagnostics.report(std::string("Syntax error: ") + yyget_text(scanner), yyget_lineno(scanner), context.currentLine);
 }
 